@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include "benchmark/benchmark.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+// Using a C library requires extern "C" to prevent function managling
+extern "C" {
+#include "../src/page_swap.c"
+}
+
+/*
+ * Throughput and fault latency of the replacement policies on synthetic traces.
+ * Configure with -DCMAKE_BUILD_TYPE=Release, the default flags do not optimize.
+ * For a JSON report to compare runs against:
+ *   ./page_swap_bench --benchmark_format=json --benchmark_out=page_swap_bench.json
+ * */
+
+#define BENCH_PAGES 16384 // pages in the simulated address space
+#define BENCH_TRACE_LENGTH (1 << 16) // references in a synthetic trace, replayed in a loop
+#define BENCH_SEED 42
+
+typedef enum {
+	TRACE_UNIFORM, // every page equally likely
+	TRACE_ZIPF, // page rank r referenced with probability ~ 1 / r^0.99
+	TRACE_SEQUENTIAL, // one scan over the whole address space after the other
+	TRACE_LOOP // a loop a quarter larger than memory, the worst case for LRU
+}trace_kind_t;
+
+static const char* const trace_names[] = {"uniform", "zipf", "sequential", "loop"};
+
+static std::vector<uint16_t> make_trace(const trace_kind_t kind, const size_t frame_count) {
+	std::vector<uint16_t> trace(BENCH_TRACE_LENGTH);
+	std::mt19937 random(BENCH_SEED);
+	if (kind == TRACE_UNIFORM) {
+		std::uniform_int_distribution<unsigned int> page(0, BENCH_PAGES - 1);
+		for (size_t i = 0; i < trace.size(); ++i) {
+			trace[i] = page(random);
+		}
+	} else if (kind == TRACE_ZIPF) {
+		std::vector<double> cdf(BENCH_PAGES);
+		double sum = 0;
+		for (size_t rank = 0; rank < BENCH_PAGES; ++rank) {
+			sum += 1 / std::pow(rank + 1, 0.99);
+			cdf[rank] = sum;
+		}
+		std::uniform_real_distribution<double> point(0, sum);
+		for (size_t i = 0; i < trace.size(); ++i) {
+			const size_t rank = std::lower_bound(cdf.begin(), cdf.end(), point(random)) - cdf.begin();
+			trace[i] = std::min<size_t>(rank, BENCH_PAGES - 1);
+		}
+	} else if (kind == TRACE_SEQUENTIAL) {
+		for (size_t i = 0; i < trace.size(); ++i) {
+			trace[i] = i % BENCH_PAGES;
+		}
+	} else {
+		const size_t loop = std::min<size_t>(frame_count + frame_count / 4, BENCH_PAGES);
+		for (size_t i = 0; i < trace.size(); ++i) {
+			trace[i] = i % loop;
+		}
+	}
+	return trace;
+}
+
+// One reference per iteration through page_swap_request, fault latency from the instrumentation
+static void BM_Policy(benchmark::State& state, const page_swap_policy_t policy, const trace_kind_t kind,
+		const size_t frame_count) {
+	const std::vector<uint16_t> trace = make_trace(kind, frame_count);
+	page_swap_t* context = page_swap_create_lazy("PAGE_SWAP_BENCH", 1, BENCH_PAGES, frame_count);
+	if (! context || ! page_swap_set_instrumentation(context, true)) {
+		page_swap_destroy(context);
+		state.SkipWithError("could not create the context");
+		return;
+	}
+
+	size_t clock_time = 0;
+	for (auto _ : state) {
+		free(page_swap_request(context, policy, trace[clock_time % trace.size()], clock_time, false));
+		++clock_time;
+	}
+
+	page_swap_instrument_stats_t stats;
+	page_swap_instrument_stats(context, &stats);
+	state.SetItemsProcessed(state.iterations());
+	state.counters["fault_rate"] = clock_time ? (double) stats.faults / clock_time : 0;
+	state.counters["fault_ns"] = stats.fault.mean_ns;
+	state.counters["fault_p99_ns"] = stats.fault.p99_ns;
+	state.counters["victim_ns"] = stats.victim_selection.mean_ns;
+	state.counters["io_ns"] = stats.io.mean_ns;
+	page_swap_destroy(context);
+}
+
+// One context in concurrent mode shared by every benchmark thread, made and freed by thread 0
+static page_swap_t* shared_context;
+
+// Scalability: each thread replays its own stretch of the trace against the shared context. With
+// memory a quarter of the address space a zipf trace mostly hits and a uniform one mostly faults
+static void BM_SharedContext(benchmark::State& state, const trace_kind_t kind) {
+	const size_t frame_count = BENCH_PAGES / 4;
+	const std::vector<uint16_t> trace = make_trace(kind, frame_count);
+	if (state.thread_index() == 0) {
+		shared_context = page_swap_create_lazy("PAGE_SWAP_BENCH_SHARED", 1, BENCH_PAGES, frame_count);
+		if (shared_context && ! page_swap_set_concurrent(shared_context, true)) {
+			page_swap_destroy(shared_context);
+			shared_context = NULL;
+		}
+	}
+
+	//the threads meet before the loop, so the context is there or not for all of them
+	size_t clock_time = 0;
+	const size_t offset = state.thread_index() * trace.size() / state.threads();
+	for (auto _ : state) {
+		if (! shared_context) {
+			state.SkipWithError("could not create the context");
+			break;
+		}
+		free(page_swap_request(shared_context, PAGE_SWAP_CLOCK, trace[(offset + clock_time) % trace.size()], clock_time,
+			false));
+		++clock_time;
+	}
+	state.SetItemsProcessed(clock_time);
+
+	if (state.thread_index() == 0) {
+		page_swap_destroy(shared_context);
+		shared_context = NULL;
+	}
+}
+BENCHMARK_CAPTURE(BM_SharedContext, hits/zipf, TRACE_ZIPF)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_CAPTURE(BM_SharedContext, faults/uniform, TRACE_UNIFORM)->ThreadRange(1, 8)->UseRealTime();
+
+// The trace driven policies take a whole trace per iteration
+static void BM_TracePolicy(benchmark::State& state, size_t (*faults_of)(const uint16_t*, const size_t, const size_t),
+		const trace_kind_t kind, const size_t frame_count) {
+	const std::vector<uint16_t> trace = make_trace(kind, frame_count);
+	size_t faults = 0;
+	for (auto _ : state) {
+		faults = faults_of(trace.data(), trace.size(), frame_count);
+		benchmark::DoNotOptimize(faults);
+	}
+	state.SetItemsProcessed(state.iterations() * trace.size());
+	state.counters["fault_rate"] = (double) faults / trace.size();
+}
+
+// Sparse 48 bit page numbers, the case the flat page table cannot represent
+static std::vector<uint64_t> sparse_pages(const size_t count) {
+	std::mt19937_64 random(BENCH_SEED);
+	std::vector<uint64_t> vpns(count);
+	for (size_t i = 0; i < count; ++i) {
+		vpns[i] = random() & (((uint64_t) 1 << 48) - 1);
+	}
+	return vpns;
+}
+
+static void BM_RadixLookup(benchmark::State& state) {
+	const std::vector<uint64_t> vpns = sparse_pages(state.range(0));
+	page_swap_radix_t* radix = page_swap_radix_create();
+	for (size_t i = 0; radix && i < vpns.size(); ++i) {
+		page_swap_radix_map(radix, vpns[i], i);
+	}
+	if (! radix) {
+		state.SkipWithError("could not create the table");
+		return;
+	}
+	size_t i = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(page_swap_radix_lookup(radix, vpns[i++ % vpns.size()]));
+	}
+	page_swap_table_stats_t stats;
+	page_swap_radix_stats(radix, &stats);
+	state.SetItemsProcessed(state.iterations());
+	state.counters["footprint_bytes"] = stats.footprint_bytes;
+	state.counters["references_per_lookup"] = stats.references_per_lookup;
+	page_swap_radix_destroy(radix);
+}
+
+static void BM_InvertedLookup(benchmark::State& state) {
+	const std::vector<uint64_t> vpns = sparse_pages(state.range(0));
+	page_swap_inverted_t* table = page_swap_inverted_create(vpns.size());
+	for (size_t i = 0; table && i < vpns.size(); ++i) {
+		page_swap_inverted_map(table, 0, vpns[i], i);
+	}
+	if (! table) {
+		state.SkipWithError("could not create the table");
+		return;
+	}
+	size_t i = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(page_swap_inverted_lookup(table, 0, vpns[i++ % vpns.size()]));
+	}
+	page_swap_table_stats_t stats;
+	page_swap_inverted_stats(table, &stats);
+	state.SetItemsProcessed(state.iterations());
+	state.counters["footprint_bytes"] = stats.footprint_bytes;
+	state.counters["references_per_lookup"] = stats.references_per_lookup;
+	page_swap_inverted_destroy(table);
+}
+BENCHMARK(BM_RadixLookup)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK(BM_InvertedLookup)->Arg(1 << 10)->Arg(1 << 16);
+
+int main(int argc, char **argv) {
+	const page_swap_policy_t policies[] = {PAGE_SWAP_LFU, PAGE_SWAP_ALRU, PAGE_SWAP_CLOCK, PAGE_SWAP_WSCLOCK,
+		PAGE_SWAP_LFU_EXACT, PAGE_SWAP_MGLRU, PAGE_SWAP_ARC, PAGE_SWAP_2Q, PAGE_SWAP_LIRS};
+	const struct {
+		const char* name;
+		size_t (*faults_of)(const uint16_t*, const size_t, const size_t);
+	} trace_policies[] = {{"OPT", optimal_page_faults}, {"ARC", adaptive_replacement_faults},
+		{"2Q", two_queue_faults}, {"LIRS", lirs_faults}};
+	const size_t frame_counts[] = {64, 1024, 8192};
+
+	for (size_t trace = 0; trace < sizeof(trace_names) / sizeof(trace_names[0]); ++trace) {
+		for (size_t size = 0; size < sizeof(frame_counts) / sizeof(frame_counts[0]); ++size) {
+			const std::string suffix = std::string("/") + trace_names[trace] + "/" + std::to_string(frame_counts[size]);
+			for (size_t policy = 0; policy < sizeof(policies) / sizeof(policies[0]); ++policy) {
+				benchmark::RegisterBenchmark((std::string("BM_Policy/") + page_swap_policy_name(policies[policy]) + suffix).c_str(),
+					BM_Policy, policies[policy], (trace_kind_t) trace, frame_counts[size]);
+			}
+			for (size_t policy = 0; policy < sizeof(trace_policies) / sizeof(trace_policies[0]); ++policy) {
+				benchmark::RegisterBenchmark((std::string("BM_TracePolicy/") + trace_policies[policy].name + suffix).c_str(),
+					BM_TracePolicy, trace_policies[policy].faults_of, (trace_kind_t) trace, frame_counts[size]);
+			}
+		}
+	}
+
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+		return 1;
+	}
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Using a C library requires extern "C" to prevent function managling
+extern "C" {
+#include "../src/page_swap.c"
+}
+
+/*
+ * Replays trace files, see page_swap_trace_convert, with every policy and frame
+ * count on all processors and prints the fault rates:
+ *   page_swap_sweep [--json] [--threads n] [--frames 64,512,4096] trace.pst...
+ * */
+
+static void usage(void) {
+	fputs("usage: page_swap_sweep [--json] [--threads n] [--frames n,n,...] trace...\n", stderr);
+}
+
+//parses a comma separated list of frame counts
+static bool parse_frames(const char* text, std::vector<size_t>& frames) {
+	frames.clear();
+	for (;;) {
+		char* end;
+		const unsigned long frame_count = strtoul(text, &end, 10);
+		if (end == text || frame_count == 0) {
+			return false;
+		}
+		frames.push_back(frame_count);
+		if (*end == '\0') {
+			return true;
+		}
+		if (*end != ',') {
+			return false;
+		}
+		text = end + 1;
+	}
+}
+
+int main(int argc, char **argv) {
+	bool json = false;
+	size_t threads = 0;
+	std::vector<size_t> frames = {64, 512, 4096};
+	std::vector<const char*> traces;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--json") == 0) {
+			json = true;
+		} else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			threads = strtoul(argv[++i], NULL, 10);
+		} else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+			if (! parse_frames(argv[++i], frames)) {
+				usage();
+				return 2;
+			}
+		} else if (argv[i][0] == '-') {
+			usage();
+			return 2;
+		} else {
+			traces.push_back(argv[i]);
+		}
+	}
+	if (traces.empty()) {
+		usage();
+		return 2;
+	}
+
+	//every policy the library has a name for
+	std::vector<page_swap_policy_t> policies;
+	for (int policy = PAGE_SWAP_LFU; page_swap_policy_name((page_swap_policy_t) policy); ++policy) {
+		policies.push_back((page_swap_policy_t) policy);
+	}
+	std::vector<page_swap_sweep_result_t> results(traces.size() * policies.size() * frames.size());
+	const std::string prefix = "PAGE_SWAP_SWEEP." + std::to_string(getpid());
+	if (! page_swap_sweep(traces.data(), traces.size(), policies.data(), policies.size(), frames.data(), frames.size(),
+			prefix.c_str(), threads, results.data())) {
+		fputs("sweep failed, check that every trace is a trace file\n", stderr);
+		return 1;
+	}
+	return page_swap_sweep_write(stdout, results.data(), results.size(), json) ? 0 : 1;
+}
@@ -2,6 +2,9 @@
 #define _PAGE_SWAP_H_
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
 
 /*
  * Returned by all page swap algorithms
@@ -10,8 +13,365 @@ typedef struct {
 	unsigned short page_requested;
 	unsigned short frame_replaced;
 	unsigned short page_replaced;
+	unsigned short process_replaced; // process whose page was replaced
 }page_request_result_t;
 
+/*
+ * One independent simulation: a page table, a frame table and the back store
+ * behind them. Contexts share no state, so separate threads can each drive
+ * their own context at the same time
+ * */
+typedef struct page_swap page_swap_t;
+
+/*
+ * Replacement algorithms a context can run
+ * */
+typedef enum {
+	PAGE_SWAP_LFU, // least_frequently_used
+	PAGE_SWAP_ALRU, // approx_least_recently_used
+	PAGE_SWAP_CLOCK, // clock_second_chance
+	PAGE_SWAP_WSCLOCK, // working_set_clock
+	PAGE_SWAP_LFU_EXACT, // exact reference counts, see page_swap_set_lfu_decay
+	PAGE_SWAP_MGLRU, // generations aged by batches of referenced frames
+	PAGE_SWAP_ARC, // adaptive replacement cache, see adaptive_replacement_faults
+	PAGE_SWAP_2Q, // see two_queue_faults
+	PAGE_SWAP_LIRS, // see lirs_faults, needs at least 2 frames
+	PAGE_SWAP_OPT // optimal_page_faults, it needs the whole trace so only a sweep runs it
+}page_swap_policy_t;
+
+/*
+ * Which frames a faulting process may take when a context simulates
+ * several processes
+ * */
+typedef enum {
+	PAGE_SWAP_GLOBAL, // any frame in the pool
+	PAGE_SWAP_LOCAL // its own frames once it holds its quota
+}page_swap_scope_t;
+
+/*
+ * Counters of one process in a context
+ * */
+typedef struct {
+	size_t references; // pages requested
+	size_t faults; // page faults taken
+	size_t frames_held; // frames holding pages of the process right now
+	double fault_rate; // faults / references, 0 before the first reference
+	size_t prefetches; // pages loaded by readahead
+	size_t prefetch_hits; // prefetched pages referenced before they were replaced
+	size_t fault_writebacks; // dirty victims written back while handling a fault of the process
+}page_swap_process_stats_t;
+
+/*
+ * Page reference trace file opened for streaming, see page_swap_trace_open
+ * */
+typedef struct page_swap_trace page_swap_trace_t;
+
+// References in every chunk of a trace file but the last
+#define PAGE_SWAP_TRACE_CHUNK_REFERENCES 65536
+
+/*
+ * One cell of a sweep: a policy replaying a trace with some number of frames
+ * */
+typedef struct {
+	const char* trace; // path of the trace file, as passed to page_swap_sweep
+	page_swap_policy_t policy;
+	size_t frame_count;
+	size_t references;
+	size_t faults; // SIZE_MAX when the cell could not be run
+	double fault_rate; // faults / references, 0 for an empty trace or a failed cell
+	double seconds; // wall time of the replay
+}page_swap_sweep_result_t;
+
+/*
+ * Page tables for large sparse virtual address spaces
+ * */
+typedef struct page_swap_radix page_swap_radix_t;
+typedef struct page_swap_inverted page_swap_inverted_t;
+
+/*
+ * Size and modelled lookup cost of a page table
+ * */
+typedef struct {
+	size_t entries; // pages mapped
+	size_t footprint_bytes; // memory the table takes
+	size_t lookups;
+	double references_per_lookup; // memory references of an average lookup
+}page_swap_table_stats_t;
+
+/*
+ * Replacement within a TLB set
+ * */
+typedef enum {
+	PAGE_SWAP_TLB_LRU,
+	PAGE_SWAP_TLB_RANDOM
+}page_swap_tlb_replacement_t;
+
+/*
+ * Shape and cost of a modelled TLB
+ * */
+typedef struct {
+	size_t entries; // total entries, a multiple of ways
+	size_t ways; // entries per set, entries for fully associative
+	page_swap_tlb_replacement_t replacement;
+	bool flush_on_switch; // untagged TLB, flushed whenever the referencing process changes
+	double hit_cycles; // cost of every lookup
+	double walk_cycles; // extra cost of a page table walk after a miss
+}page_swap_tlb_config_t;
+
+/*
+ * Counters of the TLB of a context
+ * */
+typedef struct {
+	size_t lookups;
+	size_t hits;
+	size_t misses;
+	size_t flushes; // full flushes on a process switch
+	size_t shootdowns; // entries dropped because their page was replaced
+	double hit_rate; // hits / lookups, 0 before the first lookup
+	double translation_cycles; // modelled average cost of a translation
+}page_swap_tlb_stats_t;
+
+/*
+ * Huge page counters of a context
+ * */
+typedef struct {
+	size_t huge_pages; // regions mapped as huge pages right now
+	size_t promotions;
+	size_t demotions; // huge pages split because one of their frames was replaced
+	size_t promotion_failures; // promotions given up because every block held a huge page
+	size_t quota_refusals; // promotions given up because the loads would exceed a local quota
+	size_t compaction_moves; // frame exchanges lining regions up in their blocks
+	size_t fill_loads; // base pages loaded to complete a region on promotion
+	size_t fragmented_blocks; // blocks that are not huge pages and mix pages of several regions
+}page_swap_huge_stats_t;
+
+/*
+ * Counters of the compressed pool of a context
+ * */
+typedef struct {
+	size_t stored_pages; // pages in the pool right now
+	size_t compressed_bytes; // their compressed size
+	size_t stores; // dirty pages compressed into the pool
+	size_t loads; // faults served from the pool
+	size_t rejects; // dirty pages that went to the back store, poorly compressed or no room
+	size_t writebacks; // pages written to the back store to make room
+}page_swap_pool_stats_t;
+
+/*
+ * Copy on write counters of a context
+ * */
+typedef struct {
+	size_t forks;
+	size_t shared_frames; // frames mapped by more than one process right now
+	size_t shared_mappings; // mappings of those frames beyond the first, each one a frame saved
+	size_t memory_saved_bytes; // shared_mappings times the page size
+	size_t pages_copied; // first writes to a shared page that copied it
+	size_t copies_avoided; // first writes to a page no other process mapped any more
+}page_swap_cow_stats_t;
+
+/*
+ * Latency distribution of one kind of operation, from a log linear histogram
+ * with four buckets per power of two
+ * */
+typedef struct {
+	size_t count; // operations timed
+	uint64_t total_ns;
+	double mean_ns;
+	uint64_t p50_ns; // quantiles are the lower bound of the bucket holding them
+	uint64_t p90_ns;
+	uint64_t p99_ns;
+}page_swap_latency_t;
+
+/*
+ * Counters and latencies of an instrumented context
+ * */
+typedef struct {
+	size_t hits; // references to resident pages
+	size_t faults;
+	size_t evictions; // resident pages replaced, by faults, readahead and huge page fills
+	size_t back_store_reads;
+	size_t back_store_writes;
+	page_swap_latency_t fault; // whole fault, victim selection and I/O included
+	page_swap_latency_t victim_selection;
+	page_swap_latency_t io; // write back of the victim and read of the page, pool included
+}page_swap_instrument_stats_t;
+
+// Creates a simulation with its own back store file, fills every page with
+// dummy data and loads pages 0 to frame_count - 1 into the frames. Unlike the
+// simulation set up by initialize, a swapped in page stays valid until it is replaced
+// @param back_store_name the file to create the back store in, unique per context
+// @param page_count the number of entries in the page table, at most 65528
+// @param frame_count the number of physical frames, between 1 and page_count
+// @return the new context or NULL on bad input or failure
+page_swap_t* page_swap_create(const char* const back_store_name, const size_t page_count, const size_t frame_count);
+
+// Creates a simulation of process_count processes, each with its own page table of
+// page_count pages, sharing one pool of frame_count frames and one back store.
+// A page stays valid from the fault that swaps it in until it is replaced.
+// The frames start out holding pages 0 to frame_count - 1 of process 0, replacement
+// starts out global and every quota is frame_count / process_count
+// @param page_count the pages of each process, process_count * page_count is at most 65528
+// @return the new context or NULL on bad input or failure
+page_swap_t* page_swap_create_processes(const char* const back_store_name, const size_t process_count,
+        const size_t page_count, const size_t frame_count);
+
+// Same as page_swap_create_processes but nothing is written to the back store up
+// front. A page gets its back store block the first time it is written back, until
+// then reads return its initial data. Zero copy mode is not available
+page_swap_t* page_swap_create_lazy(const char* const back_store_name, const size_t process_count,
+        const size_t page_count, const size_t frame_count);
+
+// Closes the back store and frees the context
+void page_swap_destroy(page_swap_t* const context);
+
+// References a page in the context using the given replacement algorithm
+// @param context the simulation to update
+// @param policy the algorithm picking the victim frame on a fault
+// @param page_number a page number that could be referenced
+// @param clock_time the time of the reference
+// @param write true when the reference writes the page
+// @return The page referenced, the page replaced, and the frame updated
+//         or a null pointer for no page fault or bad input, always for PAGE_SWAP_OPT
+page_request_result_t* page_swap_request(page_swap_t* const context, const page_swap_policy_t policy,
+        const uint16_t page_number, const size_t clock_time, const bool write);
+
+// Same as page_swap_request for the page table of process
+page_request_result_t* page_swap_process_request(page_swap_t* const context, const page_swap_policy_t policy,
+        const size_t process, const uint16_t page_number, const size_t clock_time, const bool write);
+
+// Chooses global or local replacement for the processes of a context
+// @return false on bad input
+bool page_swap_set_scope(page_swap_t* const context, const page_swap_scope_t scope);
+
+// Sets the frames a process may hold under local replacement. A process below its
+// quota takes frames from processes above theirs, at its quota it replaces its own
+// @param frames between 1 and the frame count of the context
+// @return false on bad input
+bool page_swap_set_quota(page_swap_t* const context, const size_t process, const size_t frames);
+
+// Turns on sequential readahead. When a fault continues a sequential run of faults
+// in its 64 page region, the following pages are loaded too, into frames picked by the
+// same policy. The window doubles on every sequential fault up to max_pages and halves
+// whenever a prefetched page is replaced without being referenced
+// @param max_pages the largest window, at most half the frame count, 0 turns readahead off
+// @return false on bad input, or for the simulation set up by initialize
+bool page_swap_set_readahead(page_swap_t* const context, const size_t max_pages);
+
+// Starts a background thread that writes dirty frames back to the back store so
+// faults mostly find clean victims and only need a read. The thread wakes when
+// fewer than low_watermark frames are clean and cleans frames until high_watermark
+// frames are clean. Page requests on the context may come from any thread while it runs
+// @param low_watermark clean frames that wake the thread, at least 1
+// @param high_watermark clean frames the thread stops at, at most the frame count
+// @return false on bad input, when already running or when the thread cannot start
+bool page_swap_start_flusher(page_swap_t* const context, const size_t low_watermark, const size_t high_watermark);
+
+// Stops the write back thread and waits for it. Also done by page_swap_destroy
+void page_swap_stop_flusher(page_swap_t* const context);
+
+// Number of dirty frames the write back thread has written back
+size_t page_swap_flusher_writebacks(const page_swap_t* const context);
+
+// Turns concurrent mode on or off. In concurrent mode page table entries are guarded
+// by striped page locks, so several threads can reference pages of one context and
+// hits proceed in parallel. Faults, aging ticks and first writes to a frame are still
+// handled one at a time. Only change the mode while no other thread uses the context
+// @return false on bad input or allocation failure
+bool page_swap_set_concurrent(page_swap_t* const context, const bool enabled);
+
+// Turns zero copy mode on or off. In zero copy mode the back store file is mapped
+// into memory and a frame is the block of the page it holds, so faults only update
+// the tables and dirty frames need no write back. Turning it on writes dirty frames
+// back, turning it off copies the resident pages into the frames again. Only change
+// the mode while no other thread uses the context
+// @return false on bad input, or when the back store file cannot be mapped
+bool page_swap_set_zero_copy(page_swap_t* const context, const bool enabled);
+
+// Puts a compressed pool of pool_bytes in front of the back store. Dirty pages that are
+// replaced are compressed into it instead of being written back, and a fault on a page
+// in the pool decompresses it without touching the back store. When a size class runs
+// out of room its oldest page is written back; pages that compress poorly go straight
+// to the back store. Resizing or turning it off writes the pool back first
+// @param pool_bytes at least one 4 KiB slab, 0 turns the pool off
+// @return false on bad input, allocation failure or in zero copy mode
+bool page_swap_set_compressed_pool(page_swap_t* const context, const size_t pool_bytes);
+
+// Copies the counters of the compressed pool into stats
+// @return false on bad input or when the pool is off
+bool page_swap_pool_stats(const page_swap_t* const context, page_swap_pool_stats_t* const stats);
+
+// Puts a set associative TLB in front of the page tables, or removes it when config
+// is NULL. Every reference looks up the TLB first and walks the page table on a miss.
+// Replacing a page shoots its entry down. With a TLB concurrent mode hits also take
+// the context lock
+// @return false on bad input or allocation failure
+bool page_swap_set_tlb(page_swap_t* const context, const page_swap_tlb_config_t* const config);
+
+// Copies the counters of the TLB into stats
+// @return false on bad input or when there is no TLB
+bool page_swap_tlb_stats(const page_swap_t* const context, page_swap_tlb_stats_t* const stats);
+
+// Turns on huge pages of span base pages. Once promote_resident pages of an aligned
+// region of span pages are resident after a fault, the region is promoted: its pages
+// are moved into an aligned block of span frames, the missing ones are loaded, and
+// a TLB maps it with a single entry. Replacing any frame of a huge page splits it
+// @param span a power of two dividing the frame count, 0 turns huge pages off
+// @param promote_resident resident pages needed for a promotion, 1 to span
+// @return false on bad input, or for the simulation set up by initialize
+bool page_swap_set_huge_pages(page_swap_t* const context, const size_t span, const size_t promote_resident);
+
+// Copies the huge page counters into stats
+// @return false on bad input or when huge pages are off
+bool page_swap_huge_stats(const page_swap_t* const context, page_swap_huge_stats_t* const stats);
+
+// Makes the exact reference counts of PAGE_SWAP_LFU_EXACT decay: every interval
+// references every count is halved, so pages that were hot long ago can be replaced
+// @param interval references between halvings, 0 keeps the counts forever
+// @return false on bad input
+bool page_swap_set_lfu_decay(page_swap_t* const context, const size_t interval);
+
+// Forks process parent into process child: the child maps every resident page of
+// the parent to the same frame, both copy on write, and gets a copy of the other
+// pages in its part of the back store. The first write of either process to a
+// shared page copies it into a frame the policy of that write takes, without
+// counting a page fault. Only fork while no other thread uses the context
+// @param child a process that maps no pages
+// @return false on bad input, a child that maps pages, in zero copy mode, with
+//         huge pages, for the context of initialize or on a back store failure
+bool page_swap_fork(page_swap_t* const context, const size_t parent, const size_t child);
+
+// Copies the copy on write counters into stats
+// @return false on bad input
+bool page_swap_cow_stats(const page_swap_t* const context, page_swap_cow_stats_t* const stats);
+
+// Turns instrumentation on or off. Every thread counts into its own set of counters
+// and histograms with atomic adds, so concurrent hits never share a lock. Turning it
+// on again starts from zero. Only change it while no other thread uses the context
+// @return false on bad input or allocation failure
+bool page_swap_set_instrumentation(page_swap_t* const context, const bool enabled);
+
+// Sums the counters and histograms of every thread into stats
+// @return false on bad input or when instrumentation is off
+bool page_swap_instrument_stats(const page_swap_t* const context, page_swap_instrument_stats_t* const stats);
+
+// Writes the counters and the non empty histogram buckets as a JSON object, as much
+// as fits into buffer and always NUL terminated when size > 0
+// @return the length of the whole object, which did not fit when >= size, or
+//         SIZE_MAX on bad input or when instrumentation is off
+size_t page_swap_instrument_json(const page_swap_t* const context, char* const buffer, const size_t size);
+
+// Copies the counters of a process into stats
+// @return false on bad input
+bool page_swap_process_stats(const page_swap_t* const context, const size_t process,
+        page_swap_process_stats_t* const stats);
+
+// read_from_back_store and write_to_back_store for the back store of a context,
+// pages of process 0
+bool page_swap_read (page_swap_t* const context, void *data, const unsigned int page);
+bool page_swap_write (page_swap_t* const context, const void *data, const unsigned int page);
+
+// The functions below run the simulation set up by initialize
+
 // Updates the frame table and page table using the page swap
 // algorithm Least Frequently Used. Using a accessbit that is updated
 // every time a page is referenced and a tracking byte for finding the minimum frame count for
@@ -22,6 +382,11 @@ typedef struct {
 //
 page_request_result_t* least_frequently_used(const uint16_t page_number, const size_t clock_time);
 
+// Same as least_frequently_used but the reference writes the page, so the
+// frame holding it is written back to the back store when it is evicted.
+// Frames only referenced by reads are dropped on eviction without a write.
+page_request_result_t* least_frequently_used_write(const uint16_t page_number, const size_t clock_time);
+
 // Updates the frame table and page table using the page swap
 // algorithm Approximately Least Recently Used. Using a accessbit that is updated
 // every time a page is referenced and a tracking byte for finding the minimum frame for
@@ -32,6 +397,194 @@ page_request_result_t* least_frequently_used(const uint16_t page_number, const s
 //
 page_request_result_t* approx_least_recently_used (const uint16_t page_number, const size_t clock_time);
 
+// Same as approx_least_recently_used but the reference writes the page, so the
+// frame holding it is written back to the back store when it is evicted
+page_request_result_t* approx_least_recently_used_write (const uint16_t page_number, const size_t clock_time);
+
+// Updates the frame table and page table using the CLOCK (second chance)
+// algorithm. A hand sweeps the frames, clearing access bits, and replaces the
+// first frame whose access bit was already clear. No aging sweep is needed.
+// @param page_number a page number that could be referenced
+// @param clock_time the time of the reference
+// @return The page referenced, the page replaced, and the frame updated
+//         or a null pointer for no page fault
+//
+page_request_result_t* clock_second_chance (const uint16_t page_number, const size_t clock_time);
+
+// Same as clock_second_chance but the reference writes the page
+page_request_result_t* clock_second_chance_write (const uint16_t page_number, const size_t clock_time);
+
+// Updates the frame table and page table using the WSClock algorithm. Works like
+// clock_second_chance, but a frame stays in the working set until clock_time has moved
+// more than the working set window past its last use. Dirty frames outside the
+// working set are written back while the hand passes them and are replaced once clean.
+// @param page_number a page number that could be referenced
+// @param clock_time the time of the reference, must not go backwards
+// @return The page referenced, the page replaced, and the frame updated
+//         or a null pointer for no page fault
+//
+page_request_result_t* working_set_clock (const uint16_t page_number, const size_t clock_time);
+
+// Same as working_set_clock but the reference writes the page
+page_request_result_t* working_set_clock_write (const uint16_t page_number, const size_t clock_time);
+
+// Counts the page faults of Belady's optimal replacement over a reference trace.
+// Runs offline in O(n log frames) and does not touch the frame table, page table
+// or back store, it is the lower bound the other algorithms are judged against
+// @param pages the page numbers in the order they are referenced
+// @param count the number of references in pages
+// @param frame_count the number of physical frames to simulate
+// @return the number of page faults, including the faults filling empty frames,
+//         or SIZE_MAX on bad input or allocation failure
+size_t optimal_page_faults (const uint16_t* pages, const size_t count, const size_t frame_count);
+
+// Counts the page faults of the Adaptive Replacement Cache (ARC) over a reference
+// trace. ARC splits the frames between recently and frequently used pages and
+// adapts the split using ghost lists of recently evicted pages, so large
+// sequential scans do not flush the hot set. O(1) per reference. Runs the same
+// steps as PAGE_SWAP_ARC in a context, starting with no page resident.
+// @param pages the page numbers in the order they are referenced
+// @param count the number of references in pages
+// @param frame_count the number of physical frames to simulate
+// @return the number of page faults or SIZE_MAX on bad input or allocation failure
+size_t adaptive_replacement_faults (const uint16_t* pages, const size_t count, const size_t frame_count);
+
+// Counts the page faults of the 2Q algorithm over a reference trace. A page has
+// to be referenced again shortly after it leaves the first in first out queue
+// before it joins the LRU main queue. O(1) per reference. Same steps as PAGE_SWAP_2Q.
+// Parameters and return value are the same as adaptive_replacement_faults
+size_t two_queue_faults (const uint16_t* pages, const size_t count, const size_t frame_count);
+
+// Counts the page faults of the LIRS algorithm over a reference trace. Pages are
+// ranked by the recency of their last two references, about one percent of the
+// frames hold pages with a long reuse distance. Amortized O(1) per reference.
+// Same steps as PAGE_SWAP_LIRS.
+// Parameters and return value are the same as adaptive_replacement_faults,
+// except that frame_count must be at least 2
+size_t lirs_faults (const uint16_t* pages, const size_t count, const size_t frame_count);
+
+// Computes the LRU miss ratio curve of a reference trace for every frame count
+// at once in a single O(n log n) pass over the trace (Mattson stack distances)
+// @param pages the page numbers in the order they are referenced
+// @param count the number of references in pages
+// @param misses filled with max_frames + 1 entries, misses[c] is the number of page
+//        faults LRU takes with c frames, cold misses included
+// @param max_frames the largest frame count to report
+// @return true on success or false on bad input or allocation failure
+bool lru_miss_counts (const uint16_t* pages, const size_t count, size_t* misses, const size_t max_frames);
+
+// Same as lru_miss_counts but only follows the pages a hash selects at sample_rate
+// and scales the result back up (SHARDS). Trades accuracy for time and memory on
+// traces too large to process exactly.
+// @param sample_rate the fraction of page numbers to follow, in (0, 1]
+bool lru_miss_counts_sampled (const uint16_t* pages, const size_t count, size_t* misses,
+        const size_t max_frames, const double sample_rate);
+
+// Radix page table over 48 bit virtual page numbers, six levels of 256 entries.
+// Memory grows with the pages mapped, not with the address space
+page_swap_radix_t* page_swap_radix_create(void);
+void page_swap_radix_destroy(page_swap_radix_t* const radix);
+
+// Maps vpn to frame, replacing any earlier mapping of vpn
+// @return false on bad input or allocation failure
+bool page_swap_radix_map(page_swap_radix_t* const radix, const uint64_t vpn, const uint32_t frame);
+
+// @return false if vpn was not mapped
+bool page_swap_radix_unmap(page_swap_radix_t* const radix, const uint64_t vpn);
+
+// @return the frame vpn maps to or UINT32_MAX if it is not mapped
+uint32_t page_swap_radix_lookup(page_swap_radix_t* const radix, const uint64_t vpn);
+
+// Copies the size and lookup cost of the table into stats
+// @return false on bad input
+bool page_swap_radix_stats(const page_swap_radix_t* const radix, page_swap_table_stats_t* const stats);
+
+// Hashed inverted page table with one entry per frame, shared by every process.
+// Memory is fixed by the frame count, lookups follow a hash chain
+// @return NULL on bad input or allocation failure
+page_swap_inverted_t* page_swap_inverted_create(const size_t frame_count);
+void page_swap_inverted_destroy(page_swap_inverted_t* const table);
+
+// Maps vpn of process to frame. Whatever frame held before and wherever vpn
+// of process was mapped before is unmapped
+// @return false on bad input
+bool page_swap_inverted_map(page_swap_inverted_t* const table, const size_t process, const uint64_t vpn,
+        const uint32_t frame);
+
+// @return false if vpn of process was not mapped
+bool page_swap_inverted_unmap(page_swap_inverted_t* const table, const size_t process, const uint64_t vpn);
+
+// @return the frame vpn of process maps to or UINT32_MAX if it is not mapped
+uint32_t page_swap_inverted_lookup(page_swap_inverted_t* const table, const size_t process, const uint64_t vpn);
+
+// Copies the size and lookup cost of the table into stats
+// @return false on bad input
+bool page_swap_inverted_stats(const page_swap_inverted_t* const table, page_swap_table_stats_t* const stats);
+
+// Writes a reference trace as a trace file: chunks of zigzag varint differences
+// between consecutive pages followed by an index of chunk offsets. Traces with
+// locality take one or two bytes per reference
+// @param path the file to create, replaced if it exists
+// @return false on bad input or I/O failure
+bool page_swap_trace_write(const char* const path, const uint16_t* pages, const size_t count);
+
+// Converts a trace of page numbers into a trace file without loading it into memory
+// @param input whitespace separated decimal page numbers, or with binary raw
+//        little endian uint16_t page numbers
+// @param output the file to create, replaced if it exists
+// @return false on a malformed input, a page number above 65535 or I/O failure
+bool page_swap_trace_convert(const char* const input, const bool binary, const char* const output);
+
+// Maps a trace file read only. The trace is decoded chunk by chunk on demand and
+// one opened trace may be read by several threads at once
+// @return the trace or NULL if the file cannot be mapped or is not a trace file
+page_swap_trace_t* page_swap_trace_open(const char* const path);
+void page_swap_trace_close(page_swap_trace_t* const trace);
+
+// @return the number of references in the trace, 0 for NULL
+size_t page_swap_trace_length(const page_swap_trace_t* const trace);
+
+// @return the number of chunks in the trace, 0 for NULL
+size_t page_swap_trace_chunk_count(const page_swap_trace_t* const trace);
+
+// Decodes one chunk of the trace
+// @param pages room for PAGE_SWAP_TRACE_CHUNK_REFERENCES page numbers
+// @return the number of page numbers decoded or SIZE_MAX on bad input or a corrupt chunk
+size_t page_swap_trace_chunk(const page_swap_trace_t* const trace, const size_t chunk, uint16_t* const pages);
+
+// Feeds every reference of the trace to page_swap_process_request as reads of
+// process, the position in the trace being the clock time
+// @return the number of page faults or SIZE_MAX on bad input, a corrupt chunk,
+//         a page outside the page table of the context, a policy the context
+//         cannot run such as PAGE_SWAP_OPT or failure
+size_t page_swap_trace_replay(const page_swap_trace_t* const trace, page_swap_t* const context,
+        const page_swap_policy_t policy, const size_t process);
+
+// Replays every trace with every policy and frame count, the cells spread over
+// worker threads. Each trace is mapped once and shared by the workers, each cell
+// gets its own lazily created context with page numbers up to the largest page of
+// its trace. PAGE_SWAP_OPT cells run optimal_page_faults over the trace instead,
+// decoded once when the traces are opened. Results are ordered by trace, then
+// policy, then frame count
+// @param back_store_prefix worker w keeps its back store in <prefix>.<w>, removed afterwards
+// @param threads worker threads, 0 for one per online processor
+// @param results room for trace_count * policy_count * frame_count_count cells
+// @return false on bad input, a trace that cannot be opened or failure to start
+//         the workers. A cell that fails on its own has faults SIZE_MAX
+bool page_swap_sweep(const char* const* trace_paths, const size_t trace_count, const page_swap_policy_t* policies,
+        const size_t policy_count, const size_t* frame_counts, const size_t frame_count_count,
+        const char* const back_store_prefix, const size_t threads, page_swap_sweep_result_t* const results);
+
+// Writes sweep results as CSV with a header line, or as a JSON array of objects
+// @return false on bad input or a write error
+bool page_swap_sweep_write(FILE* const out, const page_swap_sweep_result_t* const results, const size_t count,
+        const bool json);
+
+// Name of a policy as it appears in the sweep output, e.g. "MGLRU". Policies are
+// numbered from PAGE_SWAP_LFU up to the first value without a name
+// @return the name or NULL for a value that is not a policy
+const char* page_swap_policy_name(const page_swap_policy_t policy);
+
 // Reads a 1024 block of data from the back store into a an array data given a page index 
 // @param data used for storage of the copied data from the back store
 // @param page a logical index that references a 1024 block of data in the back store
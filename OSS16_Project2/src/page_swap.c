@@ -2,8 +2,15 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdarg.h>
 #include <assert.h>
 #include <stdint.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
 // link back store
 #include <back_store.h>
 
@@ -12,27 +19,52 @@
 // MACROS
 #define MAX_PAGE_TABLE_ENTRIES_SIZE 2048
 #define MAX_PHYSICAL_MEMORY_SIZE 512
+#define MAX_BACK_STORE_PAGES (65536 - 8) // back store blocks left after the first 8
 #define TIME_INTERVAL 100
 #define DATA_BLOCK_SIZE 1024
+#define TRACKING_BUCKET_COUNT 256 // one bucket per tracking byte value
+#define NO_FRAME UINT32_MAX // end of a bucket list
+#define ANY_PROCESS UINT32_MAX // victim may belong to any process
+#define OVER_QUOTA_PROCESSES (UINT32_MAX - 1) // victim must belong to a process holding more than its quota
+#define WORKING_SET_WINDOW (4 * TIME_INTERVAL) // ticks a frame stays in the working set after its last use
+#define READAHEAD_REGION_PAGES 64 // pages sharing one sequential stream tracker
+#define NO_STREAM SIZE_MAX // region has no sequential run going
+#define PAGE_LOCK_STRIPES 64 // page locks in concurrent mode
+#define PAGE_LOCK_RANGE 16 // consecutive pages sharing a page lock
+#define LZ_MIN_MATCH 4 // shortest match the codec encodes
+#define LZ_HASH_BITS 10
+#define POOL_SLAB_BYTES 4096 // slabs of the compressed pool, each serving one size class
+#define POOL_CLASS_BYTES 128 // size classes are multiples of this
+#define POOL_CLASS_COUNT 6 // pages compressing to more than 6 * 128 bytes go to the back store
+#define POOL_SLAB_SLOTS (POOL_SLAB_BYTES / POOL_CLASS_BYTES)
+#define PAGE_LIST_COUNT 4 // lists in a page_lists_t
+#define NO_LIST 0xff // member value of a key that is in no list
+#define NO_PAGE UINT32_MAX // end of a page list
+#define NO_SLOT UINT32_MAX
+#define GENERATION_COUNT 4 // live generations of the generational policy
+#define GENERATION_BATCH 64 // referenced frames collected before they are moved to the youngest generation
+#define INSTRUMENT_SHARDS 16 // counter sets of an instrumented context, threads are spread over them
+#define LATENCY_SUB_BITS 2 // log linear histograms have 1 << LATENCY_SUB_BITS buckets per power of two
+#define LATENCY_BUCKETS 256 // enough for every uint64_t nanosecond count
+#define HUGE_TLB_TAG ((uint64_t) 1 << 63) // marks a TLB tag covering a whole huge page
 
 // helper macro
-#define BS_PAGE_MAP(x) ((x) + 8);
+#define BS_PAGE_MAP(x) ((x) + 8)
 
 /*
- * An individual frame
+ * Manages the frame metadata. Each field is its own dense array so the
+ * aging sweep and victim bookkeeping never pull page data into the cache
  * */
 typedef struct {
-	unsigned int page_table_idx; // used for indexing the page table
-	unsigned char data[DATA_BLOCK_SIZE]; // the data that a frame can hold
-	unsigned char access_tracking_byte; // used in LRU approx
-	unsigned char access_bit; // used in LRU approx
-}frame_t;
-
-/*
- * Manages the array of frames
- * */
-typedef struct {
-	frame_t entries[MAX_PHYSICAL_MEMORY_SIZE]; // creates an frame array
+	unsigned int* page_table_idx; // used for indexing the page table
+	uint32_t* owner; // process whose page table holds the page in the frame
+	unsigned char* access_tracking_byte; // used in LRU approx
+	unsigned char* access_bit; // used in LRU approx
+	unsigned char* dirty; // set when the frame was written since it was loaded
+	size_t* last_used; // clock time the frame was last seen referenced, used in WSClock
+	unsigned char* prefetched; // loaded by readahead and not referenced since
+	uint32_t* sharers; // processes mapping the frame, more than one after a fork
+	unsigned char* reserved; // held by the fault in progress, never picked as a victim
 }frame_table_t;
 
 /*
@@ -41,6 +73,8 @@ typedef struct {
 typedef struct {
 	unsigned int frame_table_idx; // used for indexing the frame table
 	unsigned char valid; // used to tell if the page is valid or not
+	unsigned char huge; // part of a region mapped as one huge page
+	unsigned char cow; // shared by a fork, the first write copies the page
 } page_t;
 
 
@@ -48,345 +82,4667 @@ typedef struct {
  * Manages the array of pages
  * */
 typedef struct {
-	page_t entries[MAX_PAGE_TABLE_ENTRIES_SIZE]; // creates an page array
+	page_t* entries; // creates an page array
 }page_table_t;
 
+/*
+ * Per process bookkeeping of an address space sharing the frame pool
+ * */
+typedef struct {
+	size_t quota; // frames the process may hold before local replacement evicts its own
+	size_t frames_held; // frames currently holding pages of the process
+	size_t references; // pages requested
+	size_t faults; // page faults taken
+	size_t* stream_next; // per readahead region, the page that would continue the last sequential run
+	size_t readahead_window; // pages read ahead on the next sequential fault
+	size_t prefetches; // pages loaded by readahead
+	size_t prefetch_hits; // prefetched pages referenced before they were replaced
+	size_t fault_writebacks; // dirty victims written back while handling a fault of the process
+}process_t;
 
 /*
- * CONTAINS ALL structures in one structure
+ * Frames grouped into FIFO lists by a one byte key so the frame
+ * with the smallest key can be found without scanning the frame table
+ * */
+typedef struct {
+	uint32_t head[TRACKING_BUCKET_COUNT]; // oldest frame in each bucket
+	uint32_t tail[TRACKING_BUCKET_COUNT]; // newest frame in each bucket
+	uint32_t* prev; // links between frames of a bucket
+	uint32_t* next;
+	unsigned char* key; // bucket each frame is in
+	uint64_t occupied[TRACKING_BUCKET_COUNT / 64]; // bit set for every non empty bucket
+}frame_buckets_t;
+
+/*
+ * Exact reference counts as a list of frequency nodes in increasing order of
+ * count, each holding its frames oldest first. A reference moves a frame to the
+ * next node, so counting, inserting and finding the least used frame are O(1)
+ * */
+typedef struct {
+	uint32_t* node_of; // node holding every frame
+	uint32_t* prev; // links between frames of a node
+	uint32_t* next;
+	size_t* count; // reference count of every node
+	uint32_t* head; // oldest frame of every node
+	uint32_t* tail; // newest frame of every node
+	uint32_t* lower; // links between nodes
+	uint32_t* higher; // also chains the free nodes
+	uint32_t lowest; // node with the smallest count
+	uint32_t free_nodes;
+	size_t decay_interval; // references between halvings of every count, 0 for none
+	size_t until_decay;
+}frequency_list_t;
+
+/*
+ * Intrusive LRU lists over page keys. A key is in at most one list of a
+ * page_lists_t and the links are indexed directly by key, so finding, moving
+ * and dropping an entry (resident or ghost) is O(1)
+ * */
+typedef struct {
+	uint32_t* prev; // links between the keys of a list
+	uint32_t* next;
+	unsigned char* member; // list every key is in, NO_LIST when absent
+	uint32_t head[PAGE_LIST_COUNT]; // most recently used key
+	uint32_t tail[PAGE_LIST_COUNT]; // least recently used key
+	size_t size[PAGE_LIST_COUNT];
+}page_lists_t;
+
+/*
+ * State of ARC, 2Q or LIRS over the keys of frame_count frames, used by the
+ * trace counters with page numbers as keys and by a context with
+ * process * page_count + page
+ * */
+typedef struct {
+	page_swap_policy_t kind; // PAGE_SWAP_ARC, PAGE_SWAP_2Q or PAGE_SWAP_LIRS
+	size_t frame_count;
+	page_lists_t lists; // T1, T2, B1 and B2 of ARC, A1in, A1out and Am of 2Q, the stack S of LIRS
+	page_lists_t queue; // the resident HIR keys of LIRS
+	unsigned char* state; // LIRS status of every key
+	size_t target; // the size ARC aims for T1
+	size_t in_limit; // 2Q sizes of A1in and A1out
+	size_t out_limit;
+	size_t lir_count; // resident LIR keys
+	size_t lir_limit;
+	uint32_t incoming; // key of the fault in progress, NO_PAGE when none
+	unsigned char incoming_list; // list it was in when the fault started
+}list_policy_t;
+
+/*
+ * Compressed pool in front of the back store. Slabs are handed to a size class
+ * when first needed and taken back once their last slot is freed, so a class
+ * whose pages stop coming leaves its slabs to the others. Slot s lives in slab
+ * s / POOL_SLAB_SLOTS. Slots in use sit on a list per class, oldest first, so
+ * an overflow writes back the oldest page
+ * */
+typedef struct {
+	unsigned char* data; // slab_count slabs
+	size_t slab_count;
+	size_t slabs_used; // slabs carved so far, emptied ones are on free_slabs
+	uint8_t* slab_class; // size class of every slab in use, 1 to POOL_CLASS_COUNT
+	uint16_t* slab_slots_used; // slots in use in every slab
+	uint32_t* next_free_slab; // chains the emptied slabs
+	uint32_t free_slabs;
+	uint32_t* slot_of; // slot of every page of every process, NO_SLOT if it is not in the pool
+	uint32_t* key; // page held by every slot, process * page_count + page
+	uint16_t* length; // compressed bytes in every slot
+	uint32_t* older; // per class lists of slots in use, free slots of a class are chained the same way
+	uint32_t* newer;
+	uint32_t oldest[POOL_CLASS_COUNT + 1];
+	uint32_t newest[POOL_CLASS_COUNT + 1];
+	uint32_t free_slots[POOL_CLASS_COUNT + 1];
+	page_swap_pool_stats_t stats;
+}compressed_pool_t;
+
+/*
+ * Set associative TLB. Entry w of set i is at i * ways + w, tagged with the
+ * process and page it translates so processes can share it without a flush
+ * */
+typedef struct {
+	page_swap_tlb_config_t config;
+	size_t set_count;
+	uint64_t* tag; // process * page_count + page + 1, 0 for an empty entry
+	uint32_t* frame;
+	uint64_t* last_used; // lookup count at the last hit or fill, for LRU
+	uint64_t now;
+	unsigned int seed; // for random replacement
+	size_t last_process; // process of the previous lookup, for flush on switch
+	page_swap_tlb_stats_t stats;
+}tlb_t;
+
+/*
+ * What an instrumented context counts and times
+ * */
+typedef enum {
+	COUNT_HIT,
+	COUNT_FAULT,
+	COUNT_EVICTION,
+	COUNT_READ,
+	COUNT_WRITE,
+	COUNT_KINDS
+}instrument_count_t;
+
+typedef enum {
+	LATENCY_FAULT,
+	LATENCY_VICTIM,
+	LATENCY_IO,
+	LATENCY_KINDS
+}instrument_latency_t;
+
+/*
+ * Counters and histograms updated by the threads mapped to one shard. Only
+ * ever changed with atomic adds
  * */
 typedef struct {
+	uint64_t counts[COUNT_KINDS];
+	uint64_t total_ns[LATENCY_KINDS];
+	uint64_t buckets[LATENCY_KINDS][LATENCY_BUCKETS];
+}instrument_shard_t;
+
+
+/*
+ * CONTAINS ALL structures in one structure
+ * Every simulation owns one, sized when it is created
+ * */
+struct page_swap {
 
 frame_table_t frame_table;
-page_table_t page_table;
+unsigned char* frame_data; // slab holding the data of every frame, indexed like the frame table
+char* back_store_name; // file behind bs, kept for zero copy mode
+uint64_t* materialized; // lazy mode, one bit per page set once its block is in the back store, NULL otherwise
+unsigned char* store_map; // back store file mapped in zero copy mode, NULL otherwise
+size_t store_map_size;
+unsigned char* store_view; // block of page 0 of process 0 inside store_map
+compressed_pool_t* pool; // compressed pool in front of the back store, NULL when off
+tlb_t* tlb; // consulted before the page tables, NULL when off
+instrument_shard_t* instruments; // INSTRUMENT_SHARDS counter sets, NULL when off
+size_t huge_span; // base pages in a huge page, 0 when huge pages are off
+size_t huge_promote_resident; // resident pages of a region that trigger its promotion
+page_swap_huge_stats_t huge_stats;
+page_swap_cow_stats_t cow_stats; // forks and copies, the sharing itself is counted on demand
+page_table_t* page_tables; // one page table per process
+process_t* processes;
+size_t process_count;
+page_swap_scope_t scope; // which frames a faulting process may take
+bool map_on_fault; // mark the requested page valid once it is swapped in
+size_t readahead_max; // largest readahead window, 0 when readahead is off
+size_t frames_reserved; // frames with the reserved byte set
+size_t dirty_frames; // frames with the dirty byte set
+pthread_mutex_t lock; // held by page requests and the flusher, in concurrent mode only by faults
+pthread_mutex_t* page_locks; // striped locks over page table entries, NULL unless concurrent
+pthread_cond_t flush_wanted; // signalled when clean frames drop below the low watermark
+pthread_t flusher; // background write-back thread
+bool flusher_running;
+bool flusher_stop; // asks the flusher to exit
+size_t flush_low; // clean frame count that wakes the flusher
+size_t flush_high; // clean frame count the flusher stops at
+uint32_t flush_hand; // next frame the flusher looks at
+uint32_t flushing_frame; // frame the flusher writes back without the lock, NO_FRAME when none
+size_t flusher_writebacks; // dirty frames the flusher wrote back
+frame_buckets_t lru_buckets; // keyed by access tracking byte
+frame_buckets_t lfu_buckets; // keyed by number of bits set in the tracking byte
+frequency_list_t frequencies; // exact reference counts
+frame_buckets_t generations; // keyed by generation sequence number % GENERATION_COUNT
+uint64_t oldest_generation; // sequence numbers of the live generations
+uint64_t youngest_generation;
+uint32_t* generation_batch; // frames referenced since the last batch was moved
+size_t generation_batch_size;
+unsigned char* generation_pending; // set for frames in the batch
+list_policy_t* list_policy; // lists of ARC, 2Q or LIRS over the pages of every process, NULL until one of them runs
+uint32_t clock_hand; // next frame the clock policies look at
+size_t page_count; // entries in each page table
+size_t frame_count; // entries in the frame table
 back_store_t* bs;
 
-}page_swap_t;
+};
 
 
-// A Global variable that is used in the following page
-// swap algorithms
+// The simulation used by the functions that take no context
 static page_swap_t ps;
 
+/*
+* HELPER FUNCTION
+* Gets the number of bits in a provided byte and returns it
+* */
+static int get_num_bits(int byte) {
+    return __builtin_popcount((unsigned int) byte & 0xff);
+}
 
-// function to populate and fill your frame table and page tables
-// do not remove
-bool initialize (void) {
+/*
+ * HELPER FUNCTIONS
+ * Bucket lists of frames keyed by one byte
+ * */
+static void frame_buckets_clear(frame_buckets_t* buckets) {
+    for (int i = 0; i < TRACKING_BUCKET_COUNT; ++i) {
+        buckets->head[i] = NO_FRAME;
+        buckets->tail[i] = NO_FRAME;
+    }
+    memset(buckets->occupied, 0, sizeof(buckets->occupied));
+}
 
-	// needs work to create back_store properly
-	back_store_t* bs = back_store_create("PAGE_SWAP");
-	ps.bs = bs;
+//appends a frame to the end of the bucket for key
+static void frame_buckets_push(frame_buckets_t* buckets, const uint32_t frame, const unsigned char key) {
+    buckets->key[frame] = key;
+    buckets->next[frame] = NO_FRAME;
+    buckets->prev[frame] = buckets->tail[key];
 
-	unsigned char buffer[1024] = {0};
-	// requests the blocks needed
-	for (int i = 0; i < MAX_PAGE_TABLE_ENTRIES_SIZE; ++i) {
-		if(!back_store_request(ps.bs,i+8)) {
-			fputs("FAILED TO REQUEST BLOCK",stderr);
-			return false;
-		}
-		// create dummy data for blocks
-		for (int j = 0; j < 1024; ++j) {
-			buffer[j] = j % 255;
-		}
-		// fill the back store
-		if (!write_to_back_store (buffer,i)) {
-			fputs("FAILED TO WRITE TO BACK STORE",stderr);
-			return false;
-		}
-	}
+    if (buckets->tail[key] == NO_FRAME) {
+        //bucket was empty
+        buckets->head[key] = frame;
+        buckets->occupied[key >> 6] |= (uint64_t)1 << (key & 63);
+    } else {
+        buckets->next[buckets->tail[key]] = frame;
+    }
+
+    buckets->tail[key] = frame;
+}
 
-	/*zero out my tables*/
-	memset(&ps.frame_table,0,sizeof(frame_table_t));
-	memset(&ps.page_table,0,sizeof(page_table_t));
+//unlinks a frame from whatever bucket it is in
+static void frame_buckets_remove(frame_buckets_t* buckets, const uint32_t frame) {
+    const unsigned char key = buckets->key[frame];
+    const uint32_t prevFrame = buckets->prev[frame];
+    const uint32_t nextFrame = buckets->next[frame];
 
-	/* Fill the Page Table and Frame Table from 0 to 512*/
-	frame_t* frame = &ps.frame_table.entries[0];
-	page_t* page = &ps.page_table.entries[0];
-	for (int i = 0;i < MAX_PHYSICAL_MEMORY_SIZE; ++i, ++frame, ++page) {
-		// update frame table with page table index
-		frame->page_table_idx = i;
-		// set the most significant bit on accessBit
-		frame->access_bit = 128;
-		// assign tracking byte to max time
-		frame->access_tracking_byte = 255;
-		/*
-		 * Load data from back store
-		 * */
-		unsigned char* data = &frame->data[0];
-		if (!read_from_back_store (data,i)) {
-			fputs("FAILED TO READ FROM BACK STORE",stderr);
-			return false;
-		}
-		// update page table with frame table index
-		page->frame_table_idx = i;
-		page->valid = 1;
+    if (prevFrame == NO_FRAME) {
+        buckets->head[key] = nextFrame;
+    } else {
+        buckets->next[prevFrame] = nextFrame;
+    }
 
-	}
-	return true;
+    if (nextFrame == NO_FRAME) {
+        buckets->tail[key] = prevFrame;
+    } else {
+        buckets->prev[nextFrame] = prevFrame;
+    }
+
+    if (buckets->head[key] == NO_FRAME) {
+        //bucket is now empty
+        buckets->occupied[key >> 6] &= ~((uint64_t)1 << (key & 63));
+    }
 }
 
-// keep this do not delete
-void destroy(void) {
-	back_store_close(ps.bs);
+//moves a frame to the bucket for key, leaving it in place if the key is unchanged
+static void frame_buckets_move(frame_buckets_t* buckets, const uint32_t frame, const unsigned char key) {
+    if (buckets->key[frame] != key) {
+        frame_buckets_remove(buckets, frame);
+        frame_buckets_push(buckets, frame, key);
+    }
+}
+
+//returns the oldest frame in the lowest non empty bucket or NO_FRAME when empty
+static uint32_t frame_buckets_min(const frame_buckets_t* buckets) {
+    for (int i = 0; i < TRACKING_BUCKET_COUNT / 64; ++i) {
+        if (buckets->occupied[i]) {
+            return buckets->head[i * 64 + __builtin_ctzll(buckets->occupied[i])];
+        }
+    }
+
+    return NO_FRAME;
+}
+
+static bool frame_buckets_create(frame_buckets_t* buckets, const size_t frame_count) {
+    buckets->prev = (uint32_t *) malloc(frame_count * sizeof(uint32_t));
+    buckets->next = (uint32_t *) malloc(frame_count * sizeof(uint32_t));
+    buckets->key = (unsigned char *) malloc(frame_count);
+    frame_buckets_clear(buckets);
+    return buckets->prev && buckets->next && buckets->key;
+}
+
+static void frame_buckets_destroy(frame_buckets_t* buckets) {
+    free(buckets->prev);
+    free(buckets->next);
+    free(buckets->key);
 }
 
 /*
- * ALRU IMPLEMENTATION : TODO IMPLEMENT
+ * HELPER FUNCTIONS
+ * Frequency list of exact reference counts. Unlinking leaves an emptied node in
+ * place so a frame can move between two nodes before either is dropped
  * */
-
-page_request_result_t* approx_least_recently_used (const uint16_t page_number, const size_t clock_time) {
-    if (page_number >= MAX_PAGE_TABLE_ENTRIES_SIZE) {
-        return NULL;
+static uint32_t frequency_node_new(frequency_list_t* list, const size_t count, const uint32_t lower) {
+    const uint32_t node = list->free_nodes;
+    list->free_nodes = list->higher[node];
+    list->count[node] = count;
+    list->head[node] = NO_FRAME;
+    list->tail[node] = NO_FRAME;
+    list->lower[node] = lower;
+    list->higher[node] = lower == NO_FRAME ? list->lowest : list->higher[lower];
+    if (list->higher[node] != NO_FRAME) {
+        list->lower[list->higher[node]] = node;
     }
+    if (lower == NO_FRAME) {
+        list->lowest = node;
+    } else {
+        list->higher[lower] = node;
+    }
+    return node;
+}
 
-    //the result to return
-    //init to NULL until the page is validated or invalidated
-	page_request_result_t* page_req_result = NULL;
+static void frequency_node_drop_if_empty(frequency_list_t* list, const uint32_t node) {
+    if (list->head[node] != NO_FRAME) {
+        return;
+    }
+    if (list->lower[node] == NO_FRAME) {
+        list->lowest = list->higher[node];
+    } else {
+        list->higher[list->lower[node]] = list->higher[node];
+    }
+    if (list->higher[node] != NO_FRAME) {
+        list->lower[list->higher[node]] = list->lower[node];
+    }
+    list->higher[node] = list->free_nodes;
+    list->free_nodes = node;
+}
 
-    //check if page number is valid
-    bool valid = ps.page_table.entries[page_number].valid;
+static void frequency_unlink(frequency_list_t* list, const uint32_t frame) {
+    const uint32_t node = list->node_of[frame];
+    if (list->prev[frame] == NO_FRAME) {
+        list->head[node] = list->next[frame];
+    } else {
+        list->next[list->prev[frame]] = list->next[frame];
+    }
+    if (list->next[frame] == NO_FRAME) {
+        list->tail[node] = list->prev[frame];
+    } else {
+        list->prev[list->next[frame]] = list->prev[frame];
+    }
+}
 
-    //if not valid
-    if (! valid) {
-        ////////////////////////////////////////////
-        //Page is invalid, so find victim, swap data and update tables
+static void frequency_append(frequency_list_t* list, const uint32_t frame, const uint32_t node) {
+    list->node_of[frame] = node;
+    list->next[frame] = NO_FRAME;
+    list->prev[frame] = list->tail[node];
+    if (list->tail[node] == NO_FRAME) {
+        list->head[node] = frame;
+    } else {
+        list->next[list->tail[node]] = frame;
+    }
+    list->tail[node] = frame;
+}
 
-        //find a victim frame
-        int8_t minAccessValue = 0;
-        int16_t minAccessIndex = 0;
+//counts one more reference to the page in frame
+static void frequency_touch(frequency_list_t* list, const uint32_t frame) {
+    const uint32_t node = list->node_of[frame];
+    uint32_t target = list->higher[node];
+    if (target == NO_FRAME || list->count[target] != list->count[node] + 1) {
+        target = frequency_node_new(list, list->count[node] + 1, node);
+    }
+    frequency_unlink(list, frame);
+    frequency_append(list, frame, target);
+    frequency_node_drop_if_empty(list, node);
+}
 
-        for (int i = 0; i < MAX_PHYSICAL_MEMORY_SIZE; ++i) {
-            if (ps.frame_table.entries[i].access_tracking_byte < minAccessValue) {
-                //found a smaller value, so make note of it
-                minAccessValue = ps.frame_table.entries[i].access_tracking_byte;
-                minAccessIndex = i;
+//a newly loaded page starts out with the one reference that faulted it in
+static void frequency_reset(frequency_list_t* list, const uint32_t frame) {
+    const uint32_t node = list->node_of[frame];
+    frequency_unlink(list, frame);
+    frequency_node_drop_if_empty(list, node);
+    uint32_t target = list->lowest;
+    if (target == NO_FRAME || list->count[target] != 1) {
+        target = frequency_node_new(list, 1, NO_FRAME);
+    }
+    frequency_append(list, frame, target);
+}
 
-                //if at minimum possible value then break
-                if (minAccessValue == 0) {
-                    break;
-                }
+//halves every count, nodes that end up with the same count are merged in order
+static void frequency_decay(frequency_list_t* list) {
+    uint32_t node = list->lowest;
+    while (node != NO_FRAME) {
+        const uint32_t higher = list->higher[node];
+        list->count[node] = list->count[node] > 1 ? list->count[node] / 2 : 1;
+        const uint32_t lower = list->lower[node];
+        if (lower != NO_FRAME && list->count[lower] == list->count[node]) {
+            for (uint32_t frame = list->head[node]; frame != NO_FRAME; frame = list->next[frame]) {
+                list->node_of[frame] = lower;
             }
+            list->prev[list->head[node]] = list->tail[lower];
+            list->next[list->tail[lower]] = list->head[node];
+            list->tail[lower] = list->tail[node];
+            list->head[node] = NO_FRAME;
+            frequency_node_drop_if_empty(list, node);
         }
+        node = higher;
+    }
+}
 
-        //get victim page number
-        int victimPage = ps.frame_table.entries[minAccessIndex].page_table_idx;
+static bool frequency_list_create(frequency_list_t* list, const size_t frame_count) {
+    list->node_of = (uint32_t *) malloc(frame_count * sizeof(uint32_t));
+    list->prev = (uint32_t *) malloc(frame_count * sizeof(uint32_t));
+    list->next = (uint32_t *) malloc(frame_count * sizeof(uint32_t));
+    //one node per frame at most, plus one while a frame moves
+    list->count = (size_t *) malloc((frame_count + 1) * sizeof(size_t));
+    list->head = (uint32_t *) malloc((frame_count + 1) * sizeof(uint32_t));
+    list->tail = (uint32_t *) malloc((frame_count + 1) * sizeof(uint32_t));
+    list->lower = (uint32_t *) malloc((frame_count + 1) * sizeof(uint32_t));
+    list->higher = (uint32_t *) malloc((frame_count + 1) * sizeof(uint32_t));
+    if (! list->node_of || ! list->prev || ! list->next || ! list->count || ! list->head || ! list->tail
+            || ! list->lower || ! list->higher) {
+        return false;
+    }
 
-        //put victim data in backing store
-        if (! write_to_back_store(ps.frame_table.entries[minAccessIndex].data, victimPage)) {
-            printf("Failed to write to backing store.\n");
-            return NULL;
-        }
+    for (size_t node = 0; node <= frame_count; ++node) {
+        list->higher[node] = node < frame_count ? node + 1 : NO_FRAME;
+    }
+    list->free_nodes = 0;
+    list->lowest = NO_FRAME;
+    //every frame starts out referenced once, in frame order
+    const uint32_t first = frequency_node_new(list, 1, NO_FRAME);
+    for (uint32_t frame = 0; frame < frame_count; ++frame) {
+        frequency_append(list, frame, first);
+    }
+    return true;
+}
 
-        //grab new data from backing store and place in victim frame
-        if (! read_from_back_store(ps.frame_table.entries[minAccessIndex].data, page_number)) {
-            printf("Failed to read from backing store.\n");
-            return NULL;
-        }
+static void frequency_list_destroy(frequency_list_t* list) {
+    free(list->node_of);
+    free(list->prev);
+    free(list->next);
+    free(list->count);
+    free(list->head);
+    free(list->tail);
+    free(list->lower);
+    free(list->higher);
+}
 
-        //update victim frame page number
-        ps.frame_table.entries[minAccessIndex].page_table_idx = page_number;
+/*
+ * HELPER FUNCTIONS
+ * Page lists, see page_lists_t
+ * */
+static bool page_lists_create(page_lists_t* lists, const size_t key_count) {
+    lists->prev = (uint32_t *) malloc(key_count * sizeof(uint32_t));
+    lists->next = (uint32_t *) malloc(key_count * sizeof(uint32_t));
+    lists->member = (unsigned char *) malloc(key_count);
 
-        //invalidate old page belonging to the victimized frame
-        ps.page_table.entries[victimPage].valid = 0;
+    if (! lists->prev || ! lists->next || ! lists->member) {
+        return false;
+    }
 
-        //mark access bit on victim frame
-        ps.frame_table.entries[minAccessIndex].access_bit = 1;
+    memset(lists->member, NO_LIST, key_count);
+    for (int i = 0; i < PAGE_LIST_COUNT; ++i) {
+        lists->head[i] = NO_PAGE;
+        lists->tail[i] = NO_PAGE;
+        lists->size[i] = 0;
+    }
+    return true;
+}
 
-        //return results object
-        page_req_result = (page_request_result_t *) malloc(sizeof(page_request_result_t));
+static void page_lists_destroy(page_lists_t* lists) {
+    free(lists->prev);
+    free(lists->next);
+    free(lists->member);
+}
 
-        if (! page_req_result) {
-            printf("Failed to allocate memory.\n");
-            return NULL;
-        }
+//unlinks a key from whatever list it is in
+static void page_lists_remove(page_lists_t* lists, const uint32_t page) {
+    const unsigned char list = lists->member[page];
+    if (list == NO_LIST) {
+        return;
+    }
 
-        page_req_result->page_requested = page_number;
-        page_req_result->frame_replaced = minAccessIndex;
-        page_req_result->page_replaced = victimPage;
+    if (lists->prev[page] == NO_PAGE) {
+        lists->head[list] = lists->next[page];
+    } else {
+        lists->next[lists->prev[page]] = lists->next[page];
     }
 
-    //update access bit of frame table for valid entries too
-    if (valid) {
-        int frame = ps.page_table.entries[page_number].frame_table_idx;
-        ps.frame_table.entries[frame].access_bit = 1; //set access bit
+    if (lists->next[page] == NO_PAGE) {
+        lists->tail[list] = lists->prev[page];
+    } else {
+        lists->prev[lists->next[page]] = lists->prev[page];
     }
 
-    //update access byte if it is time to do so
-    if (clock_time % 99 == 0) {
-        //update access byte
-        frame_t* cFrame = NULL;
+    lists->member[page] = NO_LIST;
+    --lists->size[list];
+}
 
-        for (int i = 0; i < MAX_PHYSICAL_MEMORY_SIZE; ++i) {
-            cFrame = &ps.frame_table.entries[i];
+//moves a key to the most recently used end of list
+static void page_lists_push(page_lists_t* lists, const unsigned char list, const uint32_t page) {
+    page_lists_remove(lists, page);
 
-            //slide access byte over by 1
-            cFrame->access_tracking_byte = cFrame->access_tracking_byte >> 1;
+    lists->prev[page] = NO_PAGE;
+    lists->next[page] = lists->head[list];
+    if (lists->head[list] == NO_PAGE) {
+        lists->tail[list] = page;
+    } else {
+        lists->prev[lists->head[list]] = page;
+    }
+    lists->head[list] = page;
+    lists->member[page] = list;
+    ++lists->size[list];
+}
 
-            //tack access bit on front of it
-            cFrame->access_tracking_byte += 128 * cFrame->access_bit;
+//removes and returns the least recently used key of list, NO_PAGE when empty
+static uint32_t page_lists_pop(page_lists_t* lists, const unsigned char list) {
+    const uint32_t page = lists->tail[list];
+    if (page != NO_PAGE) {
+        page_lists_remove(lists, page);
+    }
+    return page;
+}
 
-            //zero out access bit for next time span
-            cFrame->access_bit = 0;
-        }
+//puts to in the place of from, to leaves the list it was in before
+static void page_lists_rename(page_lists_t* lists, const uint32_t from, const uint32_t to) {
+    page_lists_remove(lists, to);
+    const unsigned char list = lists->member[from];
+    if (list == NO_LIST) {
+        return;
     }
 
-	return page_req_result;
+    lists->prev[to] = lists->prev[from];
+    lists->next[to] = lists->next[from];
+    if (lists->prev[from] == NO_PAGE) {
+        lists->head[list] = to;
+    } else {
+        lists->next[lists->prev[from]] = to;
+    }
+    if (lists->next[from] == NO_PAGE) {
+        lists->tail[list] = to;
+    } else {
+        lists->prev[lists->next[from]] = to;
+    }
+    lists->member[to] = list;
+    lists->member[from] = NO_LIST;
 }
 
-/*
-* HELPER FUNCTION
-* Gets the number of bits in a provided byte and returns it
-* */
-static int get_num_bits(int byte) {
-    int i = 0;
-    int numBits = 0;
+// Tells if a key may be evicted, filter is whatever the caller passed along
+typedef bool (*accept_key_t)(const void* filter, const uint32_t key);
 
-    //iterate 8 times
-    for (i = 0; i < 8; ++i) {
-        if ((float)(byte >> 1) != (float)byte / 2) {
-            //pulled out a 1
-            numBits++;
+//least recently used key of list that accept takes, every key without accept
+static uint32_t page_lists_last(const page_lists_t* lists, const unsigned char list, accept_key_t accept,
+        const void* filter) {
+    for (uint32_t page = lists->tail[list]; page != NO_PAGE; page = lists->prev[page]) {
+        if (! accept || accept(filter, page)) {
+            return page;
         }
-
-        byte >>= 1;
     }
-
-    return numBits;
+    return NO_PAGE;
 }
 
+/*
+ * LIST POLICIES
+ * ARC, 2Q and LIRS split into the steps a context takes. A reference to a
+ * resident key is a hit. A fault calls list_policy_miss, evicts the key
+ * list_policy_victim picks when no frame is free, then inserts the faulting
+ * key. The victim is the key the algorithm would evict among those accept
+ * takes, so reserved frames and local replacement still apply
+ * */
 
 /*
- * LFU IMPLEMENTATION : TODO IMPLEMENT
+ * ARC IMPLEMENTATION
+ * Adaptive Replacement Cache. T1 holds pages seen once recently, T2 pages seen
+ * at least twice, and B1/B2 remember pages recently evicted from them. A hit in
+ * a ghost list moves the T1 target size p towards the list that would have kept it
  * */
-page_request_result_t* least_frequently_used (const uint16_t page_number, const size_t clock_time) {
-    if (page_number >= MAX_PAGE_TABLE_ENTRIES_SIZE) {
-        return NULL;
+enum { ARC_T1, ARC_T2, ARC_B1, ARC_B2 };
+
+static void arc_miss(list_policy_t* policy, const uint32_t page) {
+    const size_t b1 = policy->lists.size[ARC_B1];
+    const size_t b2 = policy->lists.size[ARC_B2];
+
+    if (policy->lists.member[page] == ARC_B1) {
+        //T1 was too small
+        policy->target += b2 > b1 ? b2 / b1 : 1;
+        policy->target = policy->target > policy->frame_count ? policy->frame_count : policy->target;
+    } else if (policy->lists.member[page] == ARC_B2) {
+        //T2 was too small
+        const size_t delta = b1 > b2 ? b1 / b2 : 1;
+        policy->target = policy->target > delta ? policy->target - delta : 0;
     }
+}
 
-    //the result to return
-    //init to NULL until the page is validated or invalidated
-	page_request_result_t* page_req_result = NULL;
+//T1 gives up a page while it is above its target, T2 otherwise
+static uint32_t arc_victim(const list_policy_t* policy, accept_key_t accept, const void* filter) {
+    const page_lists_t* lists = &policy->lists;
+    const size_t t1 = lists->size[ARC_T1];
+    const bool from_t1 = t1 > 0 && (t1 > policy->target || (policy->incoming_list == ARC_B2 && t1 == policy->target)
+        || lists->size[ARC_T2] == 0);
 
-    //check if page number is valid
-    bool valid = ps.page_table.entries[page_number].valid;
+    const uint32_t page = page_lists_last(lists, from_t1 ? ARC_T1 : ARC_T2, accept, filter);
+    return page != NO_PAGE ? page : page_lists_last(lists, from_t1 ? ARC_T2 : ARC_T1, accept, filter);
+}
 
-    //if not valid
-    if (! valid) {
-        ////////////////////////////////////////////
-        //Page is invalid, so find victim, swap data and update tables
+static void arc_evict(list_policy_t* policy, const uint32_t page) {
+    page_lists_push(&policy->lists, policy->lists.member[page] == ARC_T1 ? ARC_B1 : ARC_B2, page);
+}
 
-        //find a victim frame
-        int8_t minAccessValue = 0;
-        int16_t minAccessIndex = 0;
+static void arc_insert(list_policy_t* policy, const uint32_t page) {
+    page_lists_t* lists = &policy->lists;
+    const bool ghost = lists->member[page] == ARC_B1 || lists->member[page] == ARC_B2;
+    page_lists_push(lists, ghost ? ARC_T2 : ARC_T1, page);
 
-        for (int i = 0; i < MAX_PHYSICAL_MEMORY_SIZE; ++i) {
-            if (get_num_bits(ps.frame_table.entries[i].access_tracking_byte) < minAccessValue) {
-                //found a smaller value, so make note of it
-                minAccessValue = get_num_bits(ps.frame_table.entries[i].access_tracking_byte);
-                minAccessIndex = i;
+    //T1 and B1 together stay within frame_count pages, all four lists within twice that
+    while (lists->size[ARC_T1] + lists->size[ARC_B1] > policy->frame_count && lists->size[ARC_B1] > 0) {
+        page_lists_pop(lists, ARC_B1);
+    }
+    while (lists->size[ARC_T1] + lists->size[ARC_T2] + lists->size[ARC_B1] + lists->size[ARC_B2]
+            > 2 * policy->frame_count) {
+        page_lists_pop(lists, lists->size[ARC_B2] > 0 ? ARC_B2 : ARC_B1);
+    }
+}
 
-                //if at minimum possible value then break
-                if (minAccessValue == 0) {
-                    break;
-                }
-            }
-        }
+/*
+ * 2Q IMPLEMENTATION
+ * First references go to the FIFO A1in. Pages pushed out of A1in are remembered
+ * in the ghost FIFO A1out, and only a reference while in A1out promotes a page
+ * to the LRU Am, so a one pass scan never displaces the hot set in Am
+ * */
+enum { TWO_Q_A1IN, TWO_Q_A1OUT, TWO_Q_AM };
 
-        //get victim page number
-        int victimPage = ps.frame_table.entries[minAccessIndex].page_table_idx;
+static void two_queue_hit(list_policy_t* policy, const uint32_t page) {
+    if (policy->lists.member[page] == TWO_Q_AM) {
+        page_lists_push(&policy->lists, TWO_Q_AM, page);
+    }
+}
 
-        //put victim data in backing store
-        if (! write_to_back_store(ps.frame_table.entries[minAccessIndex].data, victimPage)) {
-            printf("Failed to write to backing store.\n");
-            return NULL;
-        }
+//a promoted page leaves A1out first, so the eviction cannot trim it or a ghost in its place
+static void two_queue_miss(list_policy_t* policy, const uint32_t page) {
+    if (policy->lists.member[page] == TWO_Q_A1OUT) {
+        page_lists_remove(&policy->lists, page);
+    }
+}
 
-        //grab new data from backing store and place in victim frame
-        if (! read_from_back_store(ps.frame_table.entries[minAccessIndex].data, page_number)) {
-            printf("Failed to read from backing store.\n");
-            return NULL;
-        }
+static uint32_t two_queue_victim(const list_policy_t* policy, accept_key_t accept, const void* filter) {
+    const page_lists_t* lists = &policy->lists;
+    const bool from_in = lists->size[TWO_Q_A1IN] > policy->in_limit || lists->size[TWO_Q_AM] == 0;
 
-        //update victim frame page number
-        ps.frame_table.entries[minAccessIndex].page_table_idx = page_number;
+    const uint32_t page = page_lists_last(lists, from_in ? TWO_Q_A1IN : TWO_Q_AM, accept, filter);
+    return page != NO_PAGE ? page : page_lists_last(lists, from_in ? TWO_Q_AM : TWO_Q_A1IN, accept, filter);
+}
 
-        //invalidate old page belonging to the victimized frame
-        ps.page_table.entries[victimPage].valid = 0;
+static void two_queue_evict(list_policy_t* policy, const uint32_t page) {
+    if (policy->lists.member[page] != TWO_Q_A1IN) {
+        page_lists_remove(&policy->lists, page);
+        return;
+    }
+    page_lists_push(&policy->lists, TWO_Q_A1OUT, page);
+    if (policy->lists.size[TWO_Q_A1OUT] > policy->out_limit) {
+        page_lists_pop(&policy->lists, TWO_Q_A1OUT);
+    }
+}
 
-        //mark access bit on victim frame
-        ps.frame_table.entries[minAccessIndex].access_bit = 1;
+static void two_queue_insert(list_policy_t* policy, const uint32_t page) {
+    const bool promoted = page == policy->incoming && policy->incoming_list == TWO_Q_A1OUT;
+    page_lists_push(&policy->lists, promoted ? TWO_Q_AM : TWO_Q_A1IN, page);
+}
 
-        //return results object
-        page_req_result = (page_request_result_t *) malloc(sizeof(page_request_result_t));
+/*
+ * LIRS IMPLEMENTATION
+ * Pages with a low inter-reference recency (LIR) keep most of the frames. The
+ * rest hold high recency (HIR) pages in the FIFO Q. The recency stack S keeps
+ * recently seen HIR pages, resident or not, so one that is referenced again
+ * while still in S is known to be hot and swaps places with the oldest LIR page
+ * */
+enum { LIRS_NONE, LIRS_LIR, LIRS_HIR, LIRS_HIR_GHOST };
 
-        if (! page_req_result) {
-            printf("Failed to allocate memory.\n");
-            return NULL;
+//drops HIR pages off the bottom of S until a LIR page is there
+static void lirs_prune(list_policy_t* policy) {
+    page_lists_t* stack = &policy->lists;
+    while (stack->tail[0] != NO_PAGE && policy->state[stack->tail[0]] != LIRS_LIR) {
+        const uint32_t page = page_lists_pop(stack, 0);
+        if (policy->state[page] == LIRS_HIR_GHOST) {
+            policy->state[page] = LIRS_NONE;
         }
-
-        page_req_result->page_requested = page_number;
-        page_req_result->frame_replaced = minAccessIndex;
-        page_req_result->page_replaced = victimPage;
     }
+}
 
-    //update access bit of frame table for valid entries too
-    if (valid) {
-        int frame = ps.page_table.entries[page_number].frame_table_idx;
-        ps.frame_table.entries[frame].access_bit = 1; //set access bit
+//page turns into a LIR page, the oldest LIR page into a resident HIR page once the LIR set is full
+static void lirs_promote(list_policy_t* policy, const uint32_t page) {
+    policy->state[page] = LIRS_LIR;
+    if (policy->lir_count < policy->lir_limit) {
+        ++policy->lir_count;
+        return;
     }
 
-    //update access byte if it is time to do so
-    if (clock_time % 99 == 0) {
-        //update access byte
-        frame_t* cFrame = NULL;
-
-        for (int i = 0; i < MAX_PHYSICAL_MEMORY_SIZE; ++i) {
-            cFrame = &ps.frame_table.entries[i];
+    const uint32_t bottom = page_lists_pop(&policy->lists, 0);
+    policy->state[bottom] = LIRS_HIR;
+    page_lists_push(&policy->queue, 0, bottom);
+    lirs_prune(policy);
+}
 
-            //slide access byte over by 1
-            cFrame->access_tracking_byte = cFrame->access_tracking_byte >> 1;
+static void lirs_hit(list_policy_t* policy, const uint32_t page) {
+    const bool in_stack = policy->lists.member[page] != NO_LIST;
+    page_lists_push(&policy->lists, 0, page);
 
-            //tack access bit on front of it
-            cFrame->access_tracking_byte += 128 * cFrame->access_bit;
+    if (policy->state[page] == LIRS_LIR) {
+        lirs_prune(policy);
+    } else if (in_stack) {
+        //reused within the LIR working set, so it becomes LIR
+        page_lists_remove(&policy->queue, page);
+        lirs_promote(policy, page);
+    } else {
+        page_lists_push(&policy->queue, 0, page);
+    }
+}
 
-            //zero out access bit for next time span
-            cFrame->access_bit = 0;
+//the oldest resident HIR page, a LIR page only when no HIR page may go
+static uint32_t lirs_victim(const list_policy_t* policy, accept_key_t accept, const void* filter) {
+    const uint32_t page = page_lists_last(&policy->queue, 0, accept, filter);
+    if (page != NO_PAGE) {
+        return page;
+    }
+    for (uint32_t lir = policy->lists.tail[0]; lir != NO_PAGE; lir = policy->lists.prev[lir]) {
+        if (policy->state[lir] == LIRS_LIR && (! accept || accept(filter, lir))) {
+            return lir;
         }
     }
+    return NO_PAGE;
+}
 
-	return page_req_result;
+//an evicted HIR page S still holds stays there as a ghost
+static void lirs_evict(list_policy_t* policy, const uint32_t page) {
+    if (policy->state[page] == LIRS_HIR) {
+        page_lists_remove(&policy->queue, page);
+        policy->state[page] = policy->lists.member[page] != NO_LIST ? LIRS_HIR_GHOST : LIRS_NONE;
+        return;
+    }
+
+    policy->state[page] = LIRS_NONE;
+    page_lists_remove(&policy->lists, page);
+    --policy->lir_count;
+    lirs_prune(policy);
 }
 
+static void lirs_insert(list_policy_t* policy, const uint32_t page) {
+    const bool in_stack = policy->lists.member[page] != NO_LIST;
+    page_lists_push(&policy->lists, 0, page);
+    if (policy->lir_count < policy->lir_limit || in_stack) {
+        //still filling the LIR set, or seen again while S remembers it
+        lirs_promote(policy, page);
+    } else {
+        policy->state[page] = LIRS_HIR;
+        page_lists_push(&policy->queue, 0, page);
+    }
+}
 
 /*
- * BACK STORE WRAPPER FUNCTIONS: TODO IMPLEMENT
+ * HELPER FUNCTIONS
+ * The steps of the list policies, dispatched on the policy of the state
  * */
-bool read_from_back_store (void *data, const unsigned int page) {
+static bool is_list_policy(const page_swap_policy_t policy) {
+    return policy == PAGE_SWAP_ARC || policy == PAGE_SWAP_2Q || policy == PAGE_SWAP_LIRS;
+}
 
-	//validate inputs
-	if (page >= MAX_PAGE_TABLE_ENTRIES_SIZE || ! data) {
+//on failure the state is left for list_policy_destroy
+static bool list_policy_create(list_policy_t* policy, const page_swap_policy_t kind, const size_t key_count,
+        const size_t frame_count) {
+    memset(policy, 0, sizeof(list_policy_t));
+    policy->kind = kind;
+    policy->frame_count = frame_count;
+    policy->incoming = NO_PAGE;
+    policy->incoming_list = NO_LIST;
+    //queue sizes recommended by Johnson and Shasha
+    policy->in_limit = frame_count / 4 > 0 ? frame_count / 4 : 1;
+    policy->out_limit = frame_count / 2 > 0 ? frame_count / 2 : 1;
+    //about one percent of the frames hold HIR pages, at least one
+    const size_t hir_limit = frame_count / 100 > 0 ? frame_count / 100 : 1;
+    policy->lir_limit = frame_count > hir_limit ? frame_count - hir_limit : 0;
+
+    if (! is_list_policy(kind) || frame_count == 0 || (kind == PAGE_SWAP_LIRS && frame_count < 2)
+            || ! page_lists_create(&policy->lists, key_count)) {
         return false;
-	}
+    }
+    if (kind == PAGE_SWAP_LIRS) {
+        policy->state = (unsigned char *) calloc(key_count, 1);
+        return page_lists_create(&policy->queue, key_count) && policy->state;
+    }
+    return true;
+}
 
-    int bsIndex = BS_PAGE_MAP(page);
+static void list_policy_destroy(list_policy_t* policy) {
+    page_lists_destroy(&policy->lists);
+    page_lists_destroy(&policy->queue);
+    free(policy->state);
+}
 
-    //get data and return it
-    bool wasSuccess = back_store_read(ps.bs, bsIndex, data);
+static bool list_policy_resident(const list_policy_t* policy, const uint32_t page) {
+    const unsigned char list = policy->lists.member[page];
+    switch (policy->kind) {
+        case PAGE_SWAP_ARC:
+            return list == ARC_T1 || list == ARC_T2;
+        case PAGE_SWAP_2Q:
+            return list == TWO_Q_A1IN || list == TWO_Q_AM;
+        default:
+            return policy->state[page] == LIRS_LIR || policy->state[page] == LIRS_HIR;
+    }
+}
 
-    //made it this far!
-	return wasSuccess;
+static void list_policy_hit(list_policy_t* policy, const uint32_t page) {
+    switch (policy->kind) {
+        case PAGE_SWAP_ARC:
+            page_lists_push(&policy->lists, ARC_T2, page);
+            break;
+        case PAGE_SWAP_2Q:
+            two_queue_hit(policy, page);
+            break;
+        default:
+            lirs_hit(policy, page);
+            break;
+    }
 }
 
-bool write_to_back_store (const void *data, const unsigned int page) {
+static void list_policy_miss(list_policy_t* policy, const uint32_t page) {
+    policy->incoming = page;
+    policy->incoming_list = policy->lists.member[page];
+    if (policy->kind == PAGE_SWAP_ARC) {
+        arc_miss(policy, page);
+    } else if (policy->kind == PAGE_SWAP_2Q) {
+        two_queue_miss(policy, page);
+    }
+}
 
-	//validate inputs
-	if (page >= MAX_PAGE_TABLE_ENTRIES_SIZE || ! data) {
-        return false;
-	}
+//NO_PAGE when accept takes no resident key
+static uint32_t list_policy_victim(const list_policy_t* policy, accept_key_t accept, const void* filter) {
+    switch (policy->kind) {
+        case PAGE_SWAP_ARC:
+            return arc_victim(policy, accept, filter);
+        case PAGE_SWAP_2Q:
+            return two_queue_victim(policy, accept, filter);
+        default:
+            return lirs_victim(policy, accept, filter);
+    }
+}
+
+static void list_policy_evict(list_policy_t* policy, const uint32_t page) {
+    switch (policy->kind) {
+        case PAGE_SWAP_ARC:
+            arc_evict(policy, page);
+            break;
+        case PAGE_SWAP_2Q:
+            two_queue_evict(policy, page);
+            break;
+        default:
+            lirs_evict(policy, page);
+            break;
+    }
+}
 
-	int bsIndex = BS_PAGE_MAP(page);
+static void list_policy_insert(list_policy_t* policy, const uint32_t page) {
+    switch (policy->kind) {
+        case PAGE_SWAP_ARC:
+            arc_insert(policy, page);
+            break;
+        case PAGE_SWAP_2Q:
+            two_queue_insert(policy, page);
+            break;
+        default:
+            lirs_insert(policy, page);
+            break;
+    }
+    policy->incoming = NO_PAGE;
+    policy->incoming_list = NO_LIST;
+}
 
-    bool wasSuccess = back_store_write(ps.bs, bsIndex, data);
+//the page of from now goes by to, as when a shared frame changes owner
+static void list_policy_rename(list_policy_t* policy, const uint32_t from, const uint32_t to) {
+    page_lists_rename(&policy->lists, from, to);
+    if (policy->kind == PAGE_SWAP_LIRS) {
+        page_lists_rename(&policy->queue, from, to);
+        policy->state[to] = policy->state[from];
+        policy->state[from] = LIRS_NONE;
+    }
+}
 
-	return wasSuccess;
+/*
+ * HELPER FUNCTIONS
+ * Instrumentation. A thread takes the next shard the first time it counts, so up
+ * to INSTRUMENT_SHARDS threads never touch the same counters. Nothing is timed
+ * when instrumentation is off
+ * */
+static __thread unsigned int thread_shard; // 1 + shard sequence number of the thread, 0 before its first count
+static unsigned int shards_taken;
+
+static instrument_shard_t* instrument_shard(const page_swap_t* const context) {
+    if (thread_shard == 0) {
+        thread_shard = __atomic_add_fetch(&shards_taken, 1, __ATOMIC_RELAXED);
+    }
+    return &context->instruments[(thread_shard - 1) % INSTRUMENT_SHARDS];
+}
+
+static void instrument_count(const page_swap_t* const context, const instrument_count_t kind) {
+    if (context->instruments) {
+        __atomic_fetch_add(&instrument_shard(context)->counts[kind], 1, __ATOMIC_RELAXED);
+    }
+}
+
+static uint64_t instrument_now(const page_swap_t* const context) {
+    if (! context->instruments) {
+        return 0;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+//values below 1 << LATENCY_SUB_BITS have a bucket each, above that every power of two
+//is split into 1 << LATENCY_SUB_BITS equal buckets
+static unsigned int latency_bucket(const uint64_t ns) {
+    const unsigned int sub_count = 1 << LATENCY_SUB_BITS;
+    if (ns < sub_count) {
+        return ns;
+    }
+    const unsigned int power = 63 - __builtin_clzll(ns);
+    return (power - LATENCY_SUB_BITS + 1) * sub_count + (ns >> (power - LATENCY_SUB_BITS) & (sub_count - 1));
+}
+
+static uint64_t latency_bucket_floor(const unsigned int bucket) {
+    const unsigned int sub_count = 1 << LATENCY_SUB_BITS;
+    if (bucket < sub_count) {
+        return bucket;
+    }
+    return (uint64_t) (sub_count + bucket % sub_count) << (bucket / sub_count - 1);
+}
+
+//records the time from start to now, start coming from instrument_now
+static void instrument_latency(const page_swap_t* const context, const instrument_latency_t kind, const uint64_t start) {
+    if (context->instruments) {
+        const uint64_t ns = instrument_now(context) - start;
+        instrument_shard_t* shard = instrument_shard(context);
+        __atomic_fetch_add(&shard->total_ns[kind], ns, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&shard->buckets[kind][latency_bucket(ns)], 1, __ATOMIC_RELAXED);
+    }
+}
+
+//sums every shard into total
+static void instrument_collect(const page_swap_t* const context, instrument_shard_t* const total) {
+    memset(total, 0, sizeof(instrument_shard_t));
+    for (int i = 0; i < INSTRUMENT_SHARDS; ++i) {
+        const instrument_shard_t* shard = &context->instruments[i];
+        for (int kind = 0; kind < COUNT_KINDS; ++kind) {
+            total->counts[kind] += __atomic_load_n(&shard->counts[kind], __ATOMIC_RELAXED);
+        }
+        for (int kind = 0; kind < LATENCY_KINDS; ++kind) {
+            total->total_ns[kind] += __atomic_load_n(&shard->total_ns[kind], __ATOMIC_RELAXED);
+            for (int bucket = 0; bucket < LATENCY_BUCKETS; ++bucket) {
+                total->buckets[kind][bucket] += __atomic_load_n(&shard->buckets[kind][bucket], __ATOMIC_RELAXED);
+            }
+        }
+    }
+}
+
+static uint64_t latency_quantile(const uint64_t* const buckets, const size_t count, const double quantile) {
+    //the sample at rank ceil(quantile * count), counting from 1
+    const double rank = quantile * count;
+    size_t seen = 0;
+    for (int bucket = 0; bucket < LATENCY_BUCKETS; ++bucket) {
+        seen += buckets[bucket];
+        if (seen > 0 && seen >= rank) {
+            return latency_bucket_floor(bucket);
+        }
+    }
+    return 0;
+}
+
+static void latency_summary(const instrument_shard_t* const total, const instrument_latency_t kind,
+        page_swap_latency_t* const latency) {
+    latency->count = 0;
+    for (int bucket = 0; bucket < LATENCY_BUCKETS; ++bucket) {
+        latency->count += total->buckets[kind][bucket];
+    }
+    latency->total_ns = total->total_ns[kind];
+    latency->mean_ns = latency->count ? (double) latency->total_ns / latency->count : 0;
+    latency->p50_ns = latency_quantile(total->buckets[kind], latency->count, 0.5);
+    latency->p90_ns = latency_quantile(total->buckets[kind], latency->count, 0.9);
+    latency->p99_ns = latency_quantile(total->buckets[kind], latency->count, 0.99);
+}
+
+bool page_swap_set_instrumentation(page_swap_t* const context, const bool enabled) {
+    if (! context) {
+        return false;
+    }
+
+    free(context->instruments);
+    context->instruments = NULL;
+    if (enabled) {
+        context->instruments = (instrument_shard_t *) calloc(INSTRUMENT_SHARDS, sizeof(instrument_shard_t));
+        if (! context->instruments) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool page_swap_instrument_stats(const page_swap_t* const context, page_swap_instrument_stats_t* const stats) {
+    if (! context || ! context->instruments || ! stats) {
+        return false;
+    }
+    instrument_shard_t* total = (instrument_shard_t *) malloc(sizeof(instrument_shard_t));
+    if (! total) {
+        return false;
+    }
+    instrument_collect(context, total);
+    stats->hits = total->counts[COUNT_HIT];
+    stats->faults = total->counts[COUNT_FAULT];
+    stats->evictions = total->counts[COUNT_EVICTION];
+    stats->back_store_reads = total->counts[COUNT_READ];
+    stats->back_store_writes = total->counts[COUNT_WRITE];
+    latency_summary(total, LATENCY_FAULT, &stats->fault);
+    latency_summary(total, LATENCY_VICTIM, &stats->victim_selection);
+    latency_summary(total, LATENCY_IO, &stats->io);
+    free(total);
+    return true;
+}
+
+//appends like snprintf at offset, which may already be past the end of buffer
+static void json_append(char* const buffer, const size_t size, size_t* const offset, const char* const format, ...) {
+    va_list args;
+    va_start(args, format);
+    const int length = vsnprintf(*offset < size ? buffer + *offset : NULL, *offset < size ? size - *offset : 0,
+        format, args);
+    va_end(args);
+    if (length > 0) {
+        *offset += length;
+    }
+}
+
+size_t page_swap_instrument_json(const page_swap_t* const context, char* const buffer, const size_t size) {
+    page_swap_instrument_stats_t stats;
+    if ((! buffer && size > 0) || ! page_swap_instrument_stats(context, &stats)) {
+        return SIZE_MAX;
+    }
+    instrument_shard_t* total = (instrument_shard_t *) malloc(sizeof(instrument_shard_t));
+    if (! total) {
+        return SIZE_MAX;
+    }
+    instrument_collect(context, total);
+
+    size_t offset = 0;
+    if (size > 0) {
+        buffer[0] = '\0';
+    }
+    json_append(buffer, size, &offset, "{\"hits\":%zu,\"faults\":%zu,\"evictions\":%zu,"
+        "\"back_store_reads\":%zu,\"back_store_writes\":%zu,\"latency_ns\":{",
+        stats.hits, stats.faults, stats.evictions, stats.back_store_reads, stats.back_store_writes);
+    const char* const names[LATENCY_KINDS] = {"fault", "victim_selection", "io"};
+    const page_swap_latency_t* const latencies[LATENCY_KINDS] = {&stats.fault, &stats.victim_selection, &stats.io};
+    for (int kind = 0; kind < LATENCY_KINDS; ++kind) {
+        const page_swap_latency_t* latency = latencies[kind];
+        json_append(buffer, size, &offset, "%s\"%s\":{\"count\":%zu,\"total\":%llu,\"mean\":%.1f,"
+            "\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"buckets\":[", kind ? "," : "", names[kind],
+            latency->count, (unsigned long long) latency->total_ns, latency->mean_ns,
+            (unsigned long long) latency->p50_ns, (unsigned long long) latency->p90_ns,
+            (unsigned long long) latency->p99_ns);
+        //non empty buckets as [lower bound, count] pairs
+        bool first = true;
+        for (int bucket = 0; bucket < LATENCY_BUCKETS; ++bucket) {
+            if (total->buckets[kind][bucket]) {
+                json_append(buffer, size, &offset, "%s[%llu,%llu]", first ? "" : ",",
+                    (unsigned long long) latency_bucket_floor(bucket),
+                    (unsigned long long) total->buckets[kind][bucket]);
+                first = false;
+            }
+        }
+        json_append(buffer, size, &offset, "]}");
+    }
+    json_append(buffer, size, &offset, "}}");
+    free(total);
+    return offset;
+}
+
+/*
+ * HELPER FUNCTION
+ * Frees everything a context holds, safe on a partly built context
+ * */
+static void pool_destroy(compressed_pool_t* const pool) {
+    if (pool) {
+        free(pool->data);
+        free(pool->slab_class);
+        free(pool->slab_slots_used);
+        free(pool->next_free_slab);
+        free(pool->slot_of);
+        free(pool->key);
+        free(pool->length);
+        free(pool->older);
+        free(pool->newer);
+        free(pool);
+    }
+}
+
+static void tlb_destroy(tlb_t* const tlb) {
+    if (tlb) {
+        free(tlb->tag);
+        free(tlb->frame);
+        free(tlb->last_used);
+        free(tlb);
+    }
+}
+
+static void page_swap_release(page_swap_t* const context) {
+    page_swap_stop_flusher(context);
+    page_swap_set_concurrent(context, false);
+    if (context->store_map) {
+        munmap(context->store_map, context->store_map_size);
+    }
+    pool_destroy(context->pool);
+    tlb_destroy(context->tlb);
+    free(context->instruments);
+    pthread_mutex_destroy(&context->lock);
+    pthread_cond_destroy(&context->flush_wanted);
+    if (context->bs) {
+        back_store_close(context->bs);
+    }
+    free(context->frame_table.page_table_idx);
+    free(context->frame_table.owner);
+    free(context->frame_table.access_tracking_byte);
+    free(context->frame_table.access_bit);
+    free(context->frame_table.dirty);
+    free(context->frame_table.last_used);
+    free(context->frame_table.prefetched);
+    free(context->frame_table.sharers);
+    free(context->frame_table.reserved);
+    free(context->frame_data);
+    free(context->back_store_name);
+    free(context->materialized);
+    if (context->page_tables) {
+        for (size_t i = 0; i < context->process_count; ++i) {
+            free(context->page_tables[i].entries);
+        }
+    }
+    free(context->page_tables);
+    if (context->processes) {
+        for (size_t i = 0; i < context->process_count; ++i) {
+            free(context->processes[i].stream_next);
+        }
+    }
+    free(context->processes);
+    frame_buckets_destroy(&context->lru_buckets);
+    frame_buckets_destroy(&context->lfu_buckets);
+    frequency_list_destroy(&context->frequencies);
+    frame_buckets_destroy(&context->generations);
+    free(context->generation_batch);
+    free(context->generation_pending);
+    if (context->list_policy) {
+        list_policy_destroy(context->list_policy);
+    }
+    free(context->list_policy);
+    memset(context, 0, sizeof(page_swap_t));
+}
+
+/*
+ * HELPER FUNCTIONS
+ * Back store access for a page of one process. Every process has its own
+ * run of page_count blocks in the back store
+ * */
+//fills pages with the dummy data every page starts out with, byte j of a page is j % 255
+static void fill_pattern(unsigned char* const data, const size_t pages) {
+    for (size_t j = 0; j < 255; ++j) {
+        data[j] = (unsigned char) j;
+    }
+    //the pattern repeats every 255 bytes and every page, so copies double it up
+    for (size_t filled = 255; filled < DATA_BLOCK_SIZE; filled *= 2) {
+        memcpy(data + filled, data, filled < DATA_BLOCK_SIZE - filled ? filled : DATA_BLOCK_SIZE - filled);
+    }
+    for (size_t filled = 1; filled < pages; filled *= 2) {
+        memcpy(data + filled * DATA_BLOCK_SIZE, data, (filled < pages - filled ? filled : pages - filled) * DATA_BLOCK_SIZE);
+    }
+}
+
+static bool read_page(page_swap_t* const context, const size_t process, void *data, const unsigned int page) {
+
+	//validate inputs
+	if (! context || ! context->bs || process >= context->process_count || page >= context->page_count || ! data) {
+        return false;
+	}
+
+    //in lazy mode a page never written back still has its initial data
+    const size_t key = process * context->page_count + page;
+    if (context->materialized && ! (context->materialized[key / 64] >> (key % 64) & 1)) {
+        fill_pattern((unsigned char *) data, 1);
+        return true;
+    }
+
+    int bsIndex = BS_PAGE_MAP(process * context->page_count + page);
+
+    //get data and return it
+    bool wasSuccess = back_store_read(context->bs, bsIndex, data);
+    if (wasSuccess) {
+        instrument_count(context, COUNT_READ);
+    }
+
+    //made it this far!
+	return wasSuccess;
+}
+
+static bool write_page(page_swap_t* const context, const size_t process, const void *data, const unsigned int page) {
+
+	//validate inputs
+	if (! context || ! context->bs || process >= context->process_count || page >= context->page_count || ! data) {
+        return false;
+	}
+
+	int bsIndex = BS_PAGE_MAP(process * context->page_count + page);
+
+    //in lazy mode the block is only requested when the page is first written
+    const size_t key = process * context->page_count + page;
+    if (context->materialized && ! (context->materialized[key / 64] >> (key % 64) & 1)) {
+        if (! back_store_request(context->bs, bsIndex)) {
+            return false;
+        }
+        context->materialized[key / 64] |= (uint64_t) 1 << (key % 64);
+    }
+
+    bool wasSuccess = back_store_write(context->bs, bsIndex, data);
+    if (wasSuccess) {
+        instrument_count(context, COUNT_WRITE);
+    }
+
+	return wasSuccess;
+}
+
+/*
+ * HELPER FUNCTION
+ * Data of a frame. In zero copy mode that is the block of the page it holds
+ * inside the back store mapping, otherwise its slot in the frame slab
+ * */
+static unsigned char* frame_bytes(const page_swap_t* const context, const uint32_t frame) {
+    if (context->store_view) {
+        return context->store_view + ((size_t) context->frame_table.owner[frame] * context->page_count
+            + context->frame_table.page_table_idx[frame]) * DATA_BLOCK_SIZE;
+    }
+    return context->frame_data + (size_t) frame * DATA_BLOCK_SIZE;
+}
+
+/*
+ * HELPER FUNCTION
+ * Maps the page blocks of the back store file, where block n lives at byte
+ * n * DATA_BLOCK_SIZE. view is set to the block of page 0 of process 0.
+ * Returns false when the file cannot be mapped or has another layout
+ * */
+static bool map_back_store(page_swap_t* const context, unsigned char** const map, size_t* const map_size,
+        unsigned char** const view) {
+    const long map_unit = sysconf(_SC_PAGESIZE);
+    const size_t first_block = BS_PAGE_MAP(0);
+    const size_t end_block = BS_PAGE_MAP(context->process_count * context->page_count);
+    const size_t first_byte = first_block * DATA_BLOCK_SIZE;
+    const size_t offset = first_byte - first_byte % map_unit;
+    const size_t end = end_block * DATA_BLOCK_SIZE;
+    struct stat file_info;
+    int fd = open(context->back_store_name, O_RDWR);
+    if (fd == -1) {
+        return false;
+    }
+    if (fstat(fd, &file_info) == -1 || (size_t) file_info.st_size < end) {
+        close(fd);
+        return false;
+    }
+    unsigned char* mapped = (unsigned char *) mmap(NULL, end - offset, PROT_READ | PROT_WRITE, MAP_SHARED, fd, offset);
+    close(fd);
+    if (mapped == (unsigned char *) MAP_FAILED) {
+        return false;
+    }
+
+    //a back store with another layout would hand out the wrong bytes, so a changed
+    //last block has to show up in the mapping
+    unsigned char block[DATA_BLOCK_SIZE];
+    const size_t last_process = context->process_count - 1;
+    const unsigned int last_page = context->page_count - 1;
+    const unsigned char* last = mapped + (end - DATA_BLOCK_SIZE - offset);
+    bool matches = read_page(context, last_process, block, last_page);
+    if (matches) {
+        block[0] ^= 0xff;
+        matches = write_page(context, last_process, block, last_page) && ! memcmp(block, last, DATA_BLOCK_SIZE);
+        block[0] ^= 0xff;
+        matches = write_page(context, last_process, block, last_page) && matches;
+    }
+    if (! matches) {
+        munmap(mapped, end - offset);
+        return false;
+    }
+
+    *map = mapped;
+    *map_size = end - offset;
+    *view = mapped + (first_byte - offset);
+    return true;
+}
+
+/*
+ * HELPER FUNCTION
+ * Creates the back store, fills every page of every process with dummy data and
+ * loads the first frame_count pages of process 0 into the frame table. The
+ * dummy data goes through a mapping of the back store file in one sequential
+ * pass, or one block at a time if the file cannot be mapped. In lazy mode
+ * nothing is written, pages get their block on their first write back
+ * */
+static bool page_swap_init(page_swap_t* const context, const char* const back_store_name,
+        const size_t process_count, const size_t page_count, const size_t frame_count, const bool lazy) {
+	memset(context, 0, sizeof(page_swap_t));
+	if (! back_store_name || process_count == 0 || frame_count == 0 || frame_count > page_count
+	        || page_count > MAX_BACK_STORE_PAGES / process_count) {
+		return false;
+	}
+
+	context->page_count = page_count;
+	context->frame_count = frame_count;
+	context->scope = PAGE_SWAP_GLOBAL;
+	context->flushing_frame = NO_FRAME;
+	pthread_mutex_init(&context->lock, NULL);
+	pthread_cond_init(&context->flush_wanted, NULL);
+
+	/*allocate and zero out my tables*/
+	frame_table_t* frame = &context->frame_table;
+	frame->page_table_idx = (unsigned int *) calloc(frame_count, sizeof(unsigned int));
+	frame->owner = (uint32_t *) calloc(frame_count, sizeof(uint32_t));
+	frame->access_tracking_byte = (unsigned char *) calloc(frame_count, 1);
+	frame->access_bit = (unsigned char *) calloc(frame_count, 1);
+	frame->dirty = (unsigned char *) calloc(frame_count, 1);
+	frame->last_used = (size_t *) calloc(frame_count, sizeof(size_t));
+	frame->prefetched = (unsigned char *) calloc(frame_count, 1);
+	frame->sharers = (uint32_t *) malloc(frame_count * sizeof(uint32_t));
+	frame->reserved = (unsigned char *) calloc(frame_count, 1);
+	context->frame_data = (unsigned char *) malloc(frame_count * DATA_BLOCK_SIZE);
+	context->processes = (process_t *) calloc(process_count, sizeof(process_t));
+	context->page_tables = (page_table_t *) calloc(process_count, sizeof(page_table_t));
+	bool created = frame_buckets_create(&context->lru_buckets, frame_count);
+	created = frame_buckets_create(&context->lfu_buckets, frame_count) && created;
+	created = frequency_list_create(&context->frequencies, frame_count) && created;
+	created = frame_buckets_create(&context->generations, frame_count) && created;
+	context->generation_batch = (uint32_t *) malloc(frame_count * sizeof(uint32_t));
+	context->generation_pending = (unsigned char *) calloc(frame_count, 1);
+	created = context->generation_batch && context->generation_pending && created;
+
+	if (context->page_tables) {
+		context->process_count = process_count;
+		for (size_t i = 0; i < process_count; ++i) {
+			context->page_tables[i].entries = (page_t *) calloc(page_count, sizeof(page_t));
+			created = context->page_tables[i].entries && created;
+		}
+	}
+
+	if (! created || ! frame->page_table_idx || ! frame->owner || ! frame->access_tracking_byte || ! frame->access_bit
+	        || ! frame->dirty || ! frame->last_used || ! frame->prefetched || ! frame->sharers || ! frame->reserved || ! context->frame_data
+	        || ! context->processes || ! context->page_tables) {
+		fputs("FAILED TO ALLOCATE TABLES",stderr);
+		page_swap_release(context);
+		return false;
+	}
+
+	//split the frames evenly for local replacement
+	for (size_t i = 0; i < process_count; ++i) {
+		context->processes[i].quota = frame_count / process_count > 0 ? frame_count / process_count : 1;
+	}
+
+	// needs work to create back_store properly
+	context->bs = back_store_create(back_store_name);
+	context->back_store_name = (char *) malloc(strlen(back_store_name) + 1);
+	if (! context->bs || ! context->back_store_name) {
+		fputs("FAILED TO CREATE BACK STORE",stderr);
+		page_swap_release(context);
+		return false;
+	}
+	strcpy(context->back_store_name, back_store_name);
+
+	if (lazy) {
+		context->materialized = (uint64_t *) calloc((process_count * page_count + 63) / 64, sizeof(uint64_t));
+		if (! context->materialized) {
+			fputs("FAILED TO ALLOCATE TABLES",stderr);
+			page_swap_release(context);
+			return false;
+		}
+	}
+
+	// requests the blocks needed
+	for (size_t process = 0; process < process_count && ! lazy; ++process) {
+		for (size_t i = 0; i < page_count; ++i) {
+			if(!back_store_request(context->bs,process * page_count + i + 8)) {
+				fputs("FAILED TO REQUEST BLOCK",stderr);
+				page_swap_release(context);
+				return false;
+			}
+		}
+	}
+
+	// fill the back store
+	unsigned char* map;
+	size_t map_size;
+	unsigned char* view;
+	if (! lazy && map_back_store(context, &map, &map_size, &view)) {
+		fill_pattern(view, process_count * page_count);
+		munmap(map, map_size);
+	} else if (! lazy) {
+		unsigned char buffer[1024];
+		fill_pattern(buffer, 1);
+		for (size_t process = 0; process < process_count; ++process) {
+			for (size_t i = 0; i < page_count; ++i) {
+				if (!write_page (context,process,buffer,i)) {
+					fputs("FAILED TO WRITE TO BACK STORE",stderr);
+					page_swap_release(context);
+					return false;
+				}
+			}
+		}
+	}
+
+	// every page starts out with the same data, so the frames need no reads
+	fill_pattern(context->frame_data, frame_count);
+
+	/* Fill the Page Table of process 0 and Frame Table from 0 to frame_count*/
+	page_t* page = &context->page_tables[0].entries[0];
+	for (size_t i = 0;i < frame_count; ++i, ++page) {
+		// update frame table with page table index
+		frame->page_table_idx[i] = i;
+		frame->sharers[i] = 1;
+		// set the most significant bit on accessBit
+		frame->access_bit[i] = 128;
+		// assign tracking byte to max time
+		frame->access_tracking_byte[i] = 255;
+		// file the frame under its tracking byte
+		frame_buckets_push(&context->lru_buckets, i, frame->access_tracking_byte[i]);
+		frame_buckets_push(&context->lfu_buckets, i, get_num_bits(frame->access_tracking_byte[i]));
+		frame_buckets_push(&context->generations, i, 0);
+		// update page table with frame table index
+		page->frame_table_idx = i;
+		page->valid = 1;
+
+	}
+	context->processes[0].frames_held = frame_count;
+	return true;
+}
+
+/*
+ * HELPER FUNCTION
+ * Allocates and sets up a context for the public constructors
+ * */
+static page_swap_t* page_swap_new(const char* const back_store_name, const size_t process_count,
+        const size_t page_count, const size_t frame_count, const bool lazy) {
+    page_swap_t* context = (page_swap_t *) malloc(sizeof(page_swap_t));
+    if (context && ! page_swap_init(context, back_store_name, process_count, page_count, frame_count, lazy)) {
+        free(context);
+        context = NULL;
+    }
+    if (context) {
+        context->map_on_fault = true;
+    }
+    return context;
+}
+
+page_swap_t* page_swap_create_processes(const char* const back_store_name, const size_t process_count,
+        const size_t page_count, const size_t frame_count) {
+    return page_swap_new(back_store_name, process_count, page_count, frame_count, false);
+}
+
+page_swap_t* page_swap_create_lazy(const char* const back_store_name, const size_t process_count,
+        const size_t page_count, const size_t frame_count) {
+    return page_swap_new(back_store_name, process_count, page_count, frame_count, true);
+}
+
+page_swap_t* page_swap_create(const char* const back_store_name, const size_t page_count, const size_t frame_count) {
+    return page_swap_create_processes(back_store_name, 1, page_count, frame_count);
+}
+
+void page_swap_destroy(page_swap_t* const context) {
+    if (context) {
+        page_swap_release(context);
+        free(context);
+    }
+}
+
+bool page_swap_set_scope(page_swap_t* const context, const page_swap_scope_t scope) {
+    if (! context || (scope != PAGE_SWAP_GLOBAL && scope != PAGE_SWAP_LOCAL)) {
+        return false;
+    }
+    context->scope = scope;
+    return true;
+}
+
+bool page_swap_set_quota(page_swap_t* const context, const size_t process, const size_t frames) {
+    if (! context || process >= context->process_count || frames == 0 || frames > context->frame_count) {
+        return false;
+    }
+    context->processes[process].quota = frames;
+    return true;
+}
+
+bool page_swap_set_readahead(page_swap_t* const context, const size_t max_pages) {
+    if (! context || ! context->map_on_fault || max_pages > context->frame_count / 2) {
+        return false;
+    }
+
+    const size_t region_count = (context->page_count + READAHEAD_REGION_PAGES - 1) / READAHEAD_REGION_PAGES;
+    for (size_t i = 0; i < context->process_count && max_pages > 0; ++i) {
+        process_t* process = &context->processes[i];
+        if (! process->stream_next) {
+            process->stream_next = (size_t *) malloc(region_count * sizeof(size_t));
+            if (! process->stream_next) {
+                return false;
+            }
+            for (size_t region = 0; region < region_count; ++region) {
+                process->stream_next[region] = NO_STREAM;
+            }
+        }
+        process->readahead_window = 0;
+    }
+
+    context->readahead_max = max_pages;
+    return true;
+}
+
+bool page_swap_process_stats(const page_swap_t* const context, const size_t process,
+        page_swap_process_stats_t* const stats) {
+    if (! context || process >= context->process_count || ! stats) {
+        return false;
+    }
+    stats->references = context->processes[process].references;
+    stats->faults = context->processes[process].faults;
+    stats->frames_held = context->processes[process].frames_held;
+    stats->prefetches = context->processes[process].prefetches;
+    stats->prefetch_hits = context->processes[process].prefetch_hits;
+    stats->fault_writebacks = context->processes[process].fault_writebacks;
+    stats->fault_rate = stats->references ? (double)stats->faults / stats->references : 0;
+    return true;
+}
+
+// function to populate and fill your frame table and page tables
+// do not remove
+// The default simulation never marks a swapped in page valid, so every
+// reference to a page outside the initial frames faults
+bool initialize (void) {
+	return page_swap_init(&ps, "PAGE_SWAP", 1, MAX_PAGE_TABLE_ENTRIES_SIZE, MAX_PHYSICAL_MEMORY_SIZE, false);
+}
+
+// keep this do not delete
+void destroy(void) {
+	page_swap_release(&ps);
+}
+
+/*
+ * HELPER FUNCTION
+ * Tells if a frame may be taken by a fault looking for candidates, which is
+ * a process number, ANY_PROCESS or OVER_QUOTA_PROCESSES. Reserved frames and the
+ * frame the flusher is writing back never are
+ * */
+static bool frame_is_candidate(const page_swap_t* const context, const uint32_t frame, const uint32_t candidates) {
+    if (context->frame_table.reserved[frame] || frame == context->flushing_frame) {
+        return false;
+    }
+    if (candidates == ANY_PROCESS) {
+        return true;
+    }
+
+    const process_t* owner = &context->processes[context->frame_table.owner[frame]];
+    if (candidates == OVER_QUOTA_PROCESSES) {
+        return owner->frames_held > owner->quota;
+    }
+    return context->frame_table.owner[frame] == candidates;
+}
+
+/*
+ * HELPER FUNCTION
+ * Works out whose frames a fault of process may take. Global replacement takes
+ * any frame. Local replacement takes one of the process' own frames once it holds
+ * its quota, otherwise a frame from a process above its quota
+ * */
+static uint32_t victim_candidates(const page_swap_t* const context, const size_t process) {
+    if (context->scope == PAGE_SWAP_GLOBAL) {
+        return ANY_PROCESS;
+    }
+
+    const process_t* faulting = &context->processes[process];
+    if (faulting->frames_held >= faulting->quota) {
+        return process;
+    }
+    for (size_t i = 0; i < context->process_count; ++i) {
+        if (context->processes[i].frames_held > context->processes[i].quota) {
+            return OVER_QUOTA_PROCESSES;
+        }
+    }
+    return faulting->frames_held > 0 ? process : ANY_PROCESS;
+}
+
+//returns the oldest frame in the lowest bucket that is a candidate
+static uint32_t frame_buckets_min_candidate(const page_swap_t* const context, const frame_buckets_t* buckets,
+        const uint32_t candidates) {
+    if (candidates == ANY_PROCESS && ! context->frames_reserved && context->flushing_frame == NO_FRAME) {
+        return frame_buckets_min(buckets);
+    }
+
+    //walk the buckets in order until a candidate turns up
+    for (int key = 0; key < TRACKING_BUCKET_COUNT; ++key) {
+        for (uint32_t frame = buckets->head[key]; frame != NO_FRAME; frame = buckets->next[frame]) {
+            if (frame_is_candidate(context, frame, candidates)) {
+                return frame;
+            }
+        }
+    }
+
+    return NO_FRAME;
+}
+
+/*
+ * HELPER FUNCTIONS
+ * Page locks of concurrent mode. A page table entry is only changed while its
+ * lock is held, so a hit can check it and touch its frame without the context
+ * lock. Faults still hold the context lock, so a thread holds at most one page
+ * lock besides it and the locks cannot deadlock. Without concurrent mode they do nothing
+ * */
+static void lock_page(const page_swap_t* const context, const size_t process, const size_t page_number) {
+    if (context->page_locks) {
+        pthread_mutex_lock(&context->page_locks[((process * context->page_count + page_number) / PAGE_LOCK_RANGE)
+            % PAGE_LOCK_STRIPES]);
+    }
+}
+
+static void unlock_page(const page_swap_t* const context, const size_t process, const size_t page_number) {
+    if (context->page_locks) {
+        pthread_mutex_unlock(&context->page_locks[((process * context->page_count + page_number) / PAGE_LOCK_RANGE)
+            % PAGE_LOCK_STRIPES]);
+    }
+}
+
+bool page_swap_set_concurrent(page_swap_t* const context, const bool enabled) {
+    if (! context) {
+        return false;
+    }
+
+    if (enabled && ! context->page_locks) {
+        context->page_locks = (pthread_mutex_t *) malloc(PAGE_LOCK_STRIPES * sizeof(pthread_mutex_t));
+        if (! context->page_locks) {
+            return false;
+        }
+        for (int i = 0; i < PAGE_LOCK_STRIPES; ++i) {
+            pthread_mutex_init(&context->page_locks[i], NULL);
+        }
+    } else if (! enabled && context->page_locks) {
+        for (int i = 0; i < PAGE_LOCK_STRIPES; ++i) {
+            pthread_mutex_destroy(&context->page_locks[i]);
+        }
+        free(context->page_locks);
+        context->page_locks = NULL;
+    }
+    return true;
+}
+
+/*
+ * HELPER FUNCTIONS
+ * The concurrent fast path reads the dirty and prefetched bytes of a frame and sets
+ * its access bit holding only a page lock, so those bytes are accessed through
+ * these relaxed atomics, which are plain moves on common targets. The aging
+ * sweep clears access bits a word at a time in concurrent mode
+ * */
+static inline unsigned char frame_flag(const unsigned char* const flags, const uint32_t frame) {
+    return __atomic_load_n(&flags[frame], __ATOMIC_RELAXED);
+}
+
+static inline void set_frame_flag(unsigned char* const flags, const uint32_t frame, const unsigned char value) {
+    __atomic_store_n(&flags[frame], value, __ATOMIC_RELAXED);
+}
+
+/*
+ * HELPER FUNCTIONS
+ * Change the dirty byte of a frame and keep the dirty frame count. Marking a frame
+ * dirty wakes the flusher when the clean frames drop below its low watermark
+ * */
+static void mark_clean(page_swap_t* const context, const uint32_t frame) {
+    if (frame_flag(context->frame_table.dirty, frame)) {
+        set_frame_flag(context->frame_table.dirty, frame, 0);
+        --context->dirty_frames;
+    }
+}
+
+static void mark_dirty(page_swap_t* const context, const uint32_t frame) {
+    if (! frame_flag(context->frame_table.dirty, frame)) {
+        set_frame_flag(context->frame_table.dirty, frame, 1);
+        ++context->dirty_frames;
+        if (context->flusher_running && context->frame_count - context->dirty_frames < context->flush_low) {
+            pthread_cond_signal(&context->flush_wanted);
+        }
+    }
+}
+
+/*
+ * HELPER FUNCTIONS
+ * Frames shared by a fork. Every process sharing a frame maps it at the page
+ * number the frame table records, the owner being the one charged for it
+ * */
+static bool frame_mapped_by(const page_swap_t* const context, const uint32_t frame, const size_t process) {
+    const page_t* page = &context->page_tables[process].entries[context->frame_table.page_table_idx[frame]];
+    return page->valid && page->frame_table_idx == frame;
+}
+
+//mappings beyond the first of every frame
+static size_t shared_mappings(const page_swap_t* const context) {
+    size_t mappings = 0;
+    for (uint32_t frame = 0; frame < context->frame_count; ++frame) {
+        mappings += context->frame_table.sharers[frame] - 1;
+    }
+    return mappings;
+}
+
+/*
+ * HELPER FUNCTION
+ * Writes a dirty frame back outside of a fault. The page lock keeps a concurrent
+ * write hit from landing between the write back and clearing the dirty byte
+ * */
+static bool clean_frame(page_swap_t* const context, const uint32_t frame) {
+    const uint32_t owner = context->frame_table.owner[frame];
+    const unsigned int page_number = context->frame_table.page_table_idx[frame];
+    bool cleaned = false;
+
+    lock_page(context, owner, page_number);
+    if (context->store_view || write_page(context, owner, frame_bytes(context, frame), page_number)) {
+        cleaned = true;
+    }
+    //a shared frame holds the page of every process mapping it
+    for (size_t process = 0; cleaned && context->frame_table.sharers[frame] > 1 && process < context->process_count;
+            ++process) {
+        if (process != owner && frame_mapped_by(context, frame, process)) {
+            cleaned = write_page(context, process, frame_bytes(context, frame), page_number);
+        }
+    }
+    if (cleaned) {
+        mark_clean(context, frame);
+    }
+    unlock_page(context, owner, page_number);
+    return cleaned;
+}
+
+bool page_swap_set_zero_copy(page_swap_t* const context, const bool enabled) {
+    if (! context || ! context->bs || ! context->back_store_name
+            || (enabled && (context->pool || context->materialized || shared_mappings(context) > 0))) {
+        return false;
+    }
+    if (enabled == (context->store_view != NULL)) {
+        return true;
+    }
+
+    if (! enabled) {
+        //give every frame its own copy again
+        for (uint32_t frame = 0; frame < context->frame_count; ++frame) {
+            memcpy(context->frame_data + (size_t) frame * DATA_BLOCK_SIZE, frame_bytes(context, frame), DATA_BLOCK_SIZE);
+        }
+        munmap(context->store_map, context->store_map_size);
+        context->store_map = NULL;
+        context->store_map_size = 0;
+        context->store_view = NULL;
+        return true;
+    }
+
+    //the private copies are dropped, so dirty ones go to the back store first
+    for (uint32_t frame = 0; frame < context->frame_count; ++frame) {
+        if (frame_flag(context->frame_table.dirty, frame) && ! clean_frame(context, frame)) {
+            return false;
+        }
+    }
+
+    unsigned char* map;
+    size_t map_size;
+    if (! map_back_store(context, &map, &map_size, &context->store_view)) {
+        return false;
+    }
+    context->store_map = map;
+    context->store_map_size = map_size;
+    return true;
+}
+
+/*
+ * HELPER FUNCTIONS
+ * LZ77 codec for one page, in the LZ4 block layout. A sequence is a token with
+ * the literal count in the high nibble and the match length - 4 in the low one,
+ * a nibble of 15 continues in bytes of up to 255, then the literals, then a two
+ * byte offset and the match. The last sequence has literals only
+ * */
+static bool lz_put_length(unsigned char* const dst, size_t* const out, const size_t capacity, size_t length) {
+    for (; length >= 255; length -= 255) {
+        if (*out >= capacity) {
+            return false;
+        }
+        dst[(*out)++] = 255;
+    }
+    if (*out >= capacity) {
+        return false;
+    }
+    dst[(*out)++] = (unsigned char) length;
+    return true;
+}
+
+static bool lz_put_sequence(unsigned char* const dst, size_t* const out, const size_t capacity,
+        const unsigned char* const literals, const size_t literal_count, const size_t offset, const size_t match) {
+    if (*out + 1 + literal_count + 2 > capacity) {
+        return false;
+    }
+    const size_t match_code = match ? match - LZ_MIN_MATCH : 0;
+    dst[(*out)++] = (unsigned char) ((literal_count < 15 ? literal_count : 15) << 4 | (match_code < 15 ? match_code : 15));
+    if (literal_count >= 15 && ! lz_put_length(dst, out, capacity, literal_count - 15)) {
+        return false;
+    }
+    if (*out + literal_count > capacity) {
+        return false;
+    }
+    memcpy(dst + *out, literals, literal_count);
+    *out += literal_count;
+    if (! match) {
+        return true;
+    }
+    if (*out + 2 > capacity) {
+        return false;
+    }
+    dst[(*out)++] = (unsigned char) (offset & 0xff);
+    dst[(*out)++] = (unsigned char) (offset >> 8);
+    return match_code < 15 || lz_put_length(dst, out, capacity, match_code - 15);
+}
+
+// Returns the compressed size, 0 if it does not fit in capacity
+static size_t lz_compress(const unsigned char* const src, unsigned char* const dst, const size_t capacity) {
+    uint16_t table[1 << LZ_HASH_BITS] = {0}; // position + 1 of the last sequence with each hash
+    size_t anchor = 0;
+    size_t out = 0;
+    size_t pos = 0;
+
+    while (pos + LZ_MIN_MATCH <= DATA_BLOCK_SIZE) {
+        uint32_t sequence;
+        memcpy(&sequence, src + pos, sizeof(sequence));
+        const uint32_t hash = (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+        const size_t candidate = table[hash];
+        table[hash] = (uint16_t) (pos + 1);
+
+        if (! candidate || memcmp(src + candidate - 1, src + pos, LZ_MIN_MATCH)) {
+            ++pos;
+            continue;
+        }
+        size_t match = LZ_MIN_MATCH;
+        while (pos + match < DATA_BLOCK_SIZE && src[candidate - 1 + match] == src[pos + match]) {
+            ++match;
+        }
+        if (! lz_put_sequence(dst, &out, capacity, src + anchor, pos - anchor, pos - (candidate - 1), match)) {
+            return 0;
+        }
+        pos += match;
+        anchor = pos;
+    }
+    if (anchor < DATA_BLOCK_SIZE
+            && ! lz_put_sequence(dst, &out, capacity, src + anchor, DATA_BLOCK_SIZE - anchor, 0, 0)) {
+        return 0;
+    }
+    return out;
+}
+
+static bool lz_get_length(const unsigned char* const src, size_t* const in, const size_t length, size_t* const value) {
+    unsigned char byte;
+    do {
+        if (*in >= length) {
+            return false;
+        }
+        byte = src[(*in)++];
+        *value += byte;
+    } while (byte == 255);
+    return true;
+}
+
+// Returns false unless src decodes to exactly one page
+static bool lz_decompress(const unsigned char* const src, const size_t length, unsigned char* const dst) {
+    size_t in = 0;
+    size_t out = 0;
+
+    while (in < length) {
+        const unsigned char token = src[in++];
+        size_t literal_count = token >> 4;
+        if (literal_count == 15 && ! lz_get_length(src, &in, length, &literal_count)) {
+            return false;
+        }
+        if (in + literal_count > length || out + literal_count > DATA_BLOCK_SIZE) {
+            return false;
+        }
+        memcpy(dst + out, src + in, literal_count);
+        in += literal_count;
+        out += literal_count;
+        if (in == length) {
+            break;
+        }
+
+        if (in + 2 > length) {
+            return false;
+        }
+        const size_t offset = src[in] | (size_t) src[in + 1] << 8;
+        in += 2;
+        size_t match = token & 15;
+        if (match == 15 && ! lz_get_length(src, &in, length, &match)) {
+            return false;
+        }
+        match += LZ_MIN_MATCH;
+        if (offset == 0 || offset > out || out + match > DATA_BLOCK_SIZE) {
+            return false;
+        }
+        //byte by byte, a match may overlap what it produces
+        for (size_t i = 0; i < match; ++i, ++out) {
+            dst[out] = dst[out - offset];
+        }
+    }
+    return out == DATA_BLOCK_SIZE;
+}
+
+/*
+ * HELPER FUNCTIONS
+ * Slots of the compressed pool
+ * */
+static void pool_unlink(compressed_pool_t* const pool, const unsigned int size_class, const uint32_t slot) {
+    if (pool->older[slot] != NO_SLOT) {
+        pool->newer[pool->older[slot]] = pool->newer[slot];
+    } else {
+        pool->oldest[size_class] = pool->newer[slot];
+    }
+    if (pool->newer[slot] != NO_SLOT) {
+        pool->older[pool->newer[slot]] = pool->older[slot];
+    } else {
+        pool->newest[size_class] = pool->older[slot];
+    }
+}
+
+static void pool_push_free(compressed_pool_t* const pool, const unsigned int size_class, const uint32_t slot) {
+    pool->older[slot] = pool->free_slots[size_class];
+    pool->newer[slot] = NO_SLOT;
+    if (pool->free_slots[size_class] != NO_SLOT) {
+        pool->newer[pool->free_slots[size_class]] = slot;
+    }
+    pool->free_slots[size_class] = slot;
+}
+
+static void pool_unlink_free(compressed_pool_t* const pool, const unsigned int size_class, const uint32_t slot) {
+    if (pool->newer[slot] != NO_SLOT) {
+        pool->older[pool->newer[slot]] = pool->older[slot];
+    } else {
+        pool->free_slots[size_class] = pool->older[slot];
+    }
+    if (pool->older[slot] != NO_SLOT) {
+        pool->newer[pool->older[slot]] = pool->newer[slot];
+    }
+}
+
+static void pool_free_slot(compressed_pool_t* const pool, const uint32_t slot) {
+    const uint32_t slab = slot / POOL_SLAB_SLOTS;
+    const unsigned int size_class = pool->slab_class[slab];
+    pool_unlink(pool, size_class, slot);
+    pool->slot_of[pool->key[slot]] = NO_SLOT;
+    pool_push_free(pool, size_class, slot);
+    --pool->stats.stored_pages;
+    pool->stats.compressed_bytes -= pool->length[slot];
+
+    //an empty slab leaves its class
+    if (--pool->slab_slots_used[slab] == 0) {
+        for (size_t i = 0; i < POOL_SLAB_SLOTS / size_class; ++i) {
+            pool_unlink_free(pool, size_class, (uint32_t) (slab * POOL_SLAB_SLOTS + i * size_class));
+        }
+        pool->slab_class[slab] = 0;
+        pool->next_free_slab[slab] = pool->free_slabs;
+        pool->free_slabs = slab;
+    }
+}
+
+// Writes the page in a slot to the back store and frees the slot
+static bool pool_write_back(page_swap_t* const context, const uint32_t slot) {
+    compressed_pool_t* pool = context->pool;
+    unsigned char block[DATA_BLOCK_SIZE];
+    const uint32_t key = pool->key[slot];
+    if (! lz_decompress(pool->data + (size_t) slot * POOL_CLASS_BYTES, pool->length[slot], block)
+            || ! write_page(context, key / context->page_count, block, key % context->page_count)) {
+        return false;
+    }
+    pool_free_slot(pool, slot);
+    ++pool->stats.writebacks;
+    return true;
+}
+
+// Finds a free slot of a size class, carving a new slab or writing back the oldest page of the class
+static uint32_t pool_take_slot(page_swap_t* const context, const unsigned int size_class) {
+    compressed_pool_t* pool = context->pool;
+    if (pool->free_slots[size_class] == NO_SLOT && (pool->free_slabs != NO_SLOT || pool->slabs_used < pool->slab_count)) {
+        //an emptied slab first, then a fresh one
+        size_t slab = pool->free_slabs;
+        if (slab != NO_SLOT) {
+            pool->free_slabs = pool->next_free_slab[slab];
+        } else {
+            slab = pool->slabs_used++;
+        }
+        pool->slab_class[slab] = (uint8_t) size_class;
+        //slots of a class start every size_class chunks
+        for (size_t i = POOL_SLAB_SLOTS / size_class; i-- > 0;) {
+            pool_push_free(pool, size_class, (uint32_t) (slab * POOL_SLAB_SLOTS + i * size_class));
+        }
+    }
+    if (pool->free_slots[size_class] == NO_SLOT && pool->oldest[size_class] != NO_SLOT) {
+        pool_write_back(context, pool->oldest[size_class]);
+    }
+
+    const uint32_t slot = pool->free_slots[size_class];
+    if (slot != NO_SLOT) {
+        pool_unlink_free(pool, size_class, slot);
+        ++pool->slab_slots_used[slot / POOL_SLAB_SLOTS];
+    }
+    return slot;
+}
+
+/*
+ * HELPER FUNCTION
+ * Compresses an evicted dirty page into the pool.
+ * Returns false when it has to go to the back store instead
+ * */
+static bool pool_store(page_swap_t* const context, const size_t process, const unsigned int page_number,
+        const unsigned char* const data) {
+    compressed_pool_t* pool = context->pool;
+    const uint32_t key = (uint32_t) (process * context->page_count + page_number);
+    unsigned char compressed[POOL_CLASS_COUNT * POOL_CLASS_BYTES];
+
+    if (pool->slot_of[key] != NO_SLOT) {
+        pool_free_slot(pool, pool->slot_of[key]);
+    }
+    const size_t length = lz_compress(data, compressed, sizeof(compressed));
+    const uint32_t slot = length ? pool_take_slot(context, (length + POOL_CLASS_BYTES - 1) / POOL_CLASS_BYTES) : NO_SLOT;
+    if (slot == NO_SLOT) {
+        ++pool->stats.rejects;
+        return false;
+    }
+
+    const unsigned int size_class = pool->slab_class[slot / POOL_SLAB_SLOTS];
+    memcpy(pool->data + (size_t) slot * POOL_CLASS_BYTES, compressed, length);
+    pool->length[slot] = (uint16_t) length;
+    pool->key[slot] = key;
+    pool->slot_of[key] = slot;
+    pool->older[slot] = pool->newest[size_class];
+    pool->newer[slot] = NO_SLOT;
+    if (pool->newest[size_class] != NO_SLOT) {
+        pool->newer[pool->newest[size_class]] = slot;
+    } else {
+        pool->oldest[size_class] = slot;
+    }
+    pool->newest[size_class] = slot;
+    ++pool->stats.stored_pages;
+    pool->stats.compressed_bytes += length;
+    ++pool->stats.stores;
+    return true;
+}
+
+/*
+ * HELPER FUNCTION
+ * Decompresses a page held by the pool into data, releasing its slot if asked.
+ * Returns false when the page is not in the pool
+ * */
+static bool pool_load(page_swap_t* const context, const size_t process, const unsigned int page_number,
+        unsigned char* const data, const bool release) {
+    compressed_pool_t* pool = context->pool;
+    if (! pool) {
+        return false;
+    }
+    const uint32_t slot = pool->slot_of[process * context->page_count + page_number];
+    if (slot == NO_SLOT || ! lz_decompress(pool->data + (size_t) slot * POOL_CLASS_BYTES, pool->length[slot], data)) {
+        return false;
+    }
+    if (release) {
+        pool_free_slot(pool, slot);
+        ++pool->stats.loads;
+    }
+    return true;
+}
+
+bool page_swap_set_compressed_pool(page_swap_t* const context, const size_t pool_bytes) {
+    if (! context || ! context->bs || context->store_view || (pool_bytes && pool_bytes < POOL_SLAB_BYTES)) {
+        return false;
+    }
+
+    //write everything back before the pool goes away or changes size
+    if (context->pool) {
+        compressed_pool_t* pool = context->pool;
+        for (unsigned int size_class = 1; size_class <= POOL_CLASS_COUNT; ++size_class) {
+            while (pool->oldest[size_class] != NO_SLOT) {
+                if (! pool_write_back(context, pool->oldest[size_class])) {
+                    return false;
+                }
+            }
+        }
+        pool_destroy(pool);
+        context->pool = NULL;
+    }
+    if (pool_bytes == 0) {
+        return true;
+    }
+
+    compressed_pool_t* pool = (compressed_pool_t *) calloc(1, sizeof(compressed_pool_t));
+    if (! pool) {
+        return false;
+    }
+    const size_t page_total = context->process_count * context->page_count;
+    const size_t slot_count = pool_bytes / POOL_SLAB_BYTES * POOL_SLAB_SLOTS;
+    pool->slab_count = pool_bytes / POOL_SLAB_BYTES;
+    pool->data = (unsigned char *) malloc(pool->slab_count * POOL_SLAB_BYTES);
+    pool->slab_class = (uint8_t *) calloc(pool->slab_count, sizeof(uint8_t));
+    pool->slab_slots_used = (uint16_t *) calloc(pool->slab_count, sizeof(uint16_t));
+    pool->next_free_slab = (uint32_t *) malloc(pool->slab_count * sizeof(uint32_t));
+    pool->slot_of = (uint32_t *) malloc(page_total * sizeof(uint32_t));
+    pool->key = (uint32_t *) malloc(slot_count * sizeof(uint32_t));
+    pool->length = (uint16_t *) malloc(slot_count * sizeof(uint16_t));
+    pool->older = (uint32_t *) malloc(slot_count * sizeof(uint32_t));
+    pool->newer = (uint32_t *) malloc(slot_count * sizeof(uint32_t));
+    if (! pool->data || ! pool->slab_class || ! pool->slab_slots_used || ! pool->next_free_slab || ! pool->slot_of || ! pool->key || ! pool->length
+            || ! pool->older || ! pool->newer) {
+        pool_destroy(pool);
+        return false;
+    }
+    memset(pool->slot_of, 0xff, page_total * sizeof(uint32_t));
+    memset(pool->oldest, 0xff, sizeof(pool->oldest));
+    memset(pool->newest, 0xff, sizeof(pool->newest));
+    memset(pool->free_slots, 0xff, sizeof(pool->free_slots));
+    pool->free_slabs = NO_SLOT;
+    context->pool = pool;
+    return true;
+}
+
+bool page_swap_pool_stats(const page_swap_t* const context, page_swap_pool_stats_t* const stats) {
+    if (! context || ! context->pool || ! stats) {
+        return false;
+    }
+    *stats = context->pool->stats;
+    return true;
+}
+
+/*
+ * HELPER FUNCTIONS
+ * TLB lookups, fills and shootdowns. Lookups return NO_FRAME on a miss or
+ * when there is no TLB. A huge page takes one entry for its whole span,
+ * tagged by its first page and pointing at its first frame
+ * */
+static uint64_t tlb_tag(const page_swap_t* const context, const size_t process, const unsigned int page_number,
+        uint32_t* const offset) {
+    *offset = context->page_tables[process].entries[page_number].huge ? page_number % context->huge_span : 0;
+    const uint64_t tag = (uint64_t) process * context->page_count + page_number - *offset + 1;
+    return context->page_tables[process].entries[page_number].huge ? tag | HUGE_TLB_TAG : tag;
+}
+
+static uint32_t tlb_lookup(page_swap_t* const context, const size_t process, const unsigned int page_number) {
+    tlb_t* tlb = context->tlb;
+    if (! tlb) {
+        return NO_FRAME;
+    }
+
+    //an untagged TLB forgets everything when another process runs
+    if (tlb->config.flush_on_switch && process != tlb->last_process) {
+        memset(tlb->tag, 0, tlb->config.entries * sizeof(uint64_t));
+        ++tlb->stats.flushes;
+    }
+    tlb->last_process = process;
+    ++tlb->stats.lookups;
+    ++tlb->now;
+
+    uint32_t offset;
+    const uint64_t tag = tlb_tag(context, process, page_number, &offset);
+    const size_t first = (tag - 1) % tlb->set_count * tlb->config.ways;
+    for (size_t entry = first; entry < first + tlb->config.ways; ++entry) {
+        if (tlb->tag[entry] == tag) {
+            tlb->last_used[entry] = tlb->now;
+            ++tlb->stats.hits;
+            return tlb->frame[entry] + offset;
+        }
+    }
+    ++tlb->stats.misses;
+    return NO_FRAME;
+}
+
+static void tlb_fill(page_swap_t* const context, const size_t process, const unsigned int page_number,
+        const uint32_t frame) {
+    tlb_t* tlb = context->tlb;
+    if (! tlb) {
+        return;
+    }
+
+    uint32_t offset;
+    const uint64_t tag = tlb_tag(context, process, page_number, &offset);
+    const size_t first = (tag - 1) % tlb->set_count * tlb->config.ways;
+    size_t victim = first;
+    for (size_t entry = first; entry < first + tlb->config.ways; ++entry) {
+        //an empty entry or the page itself beats any replacement choice
+        if (tlb->tag[entry] == 0 || tlb->tag[entry] == tag) {
+            victim = entry;
+            break;
+        }
+        if (tlb->config.replacement == PAGE_SWAP_TLB_LRU && tlb->last_used[entry] < tlb->last_used[victim]) {
+            victim = entry;
+        }
+        if (tlb->config.replacement == PAGE_SWAP_TLB_RANDOM && entry + 1 == first + tlb->config.ways) {
+            victim = first + rand_r(&tlb->seed) % tlb->config.ways;
+        }
+    }
+    tlb->tag[victim] = tag;
+    tlb->frame[victim] = frame - offset;
+    tlb->last_used[victim] = tlb->now;
+}
+
+static void tlb_invalidate(page_swap_t* const context, const size_t process, const unsigned int page_number) {
+    tlb_t* tlb = context->tlb;
+    if (! tlb) {
+        return;
+    }
+
+    uint32_t offset;
+    const uint64_t tag = tlb_tag(context, process, page_number, &offset);
+    const size_t first = (tag - 1) % tlb->set_count * tlb->config.ways;
+    for (size_t entry = first; entry < first + tlb->config.ways; ++entry) {
+        if (tlb->tag[entry] == tag) {
+            tlb->tag[entry] = 0;
+            ++tlb->stats.shootdowns;
+        }
+    }
+}
+
+bool page_swap_set_tlb(page_swap_t* const context, const page_swap_tlb_config_t* const config) {
+    if (! context || (config && (config->entries == 0 || config->ways == 0 || config->entries % config->ways
+            || config->hit_cycles < 0 || config->walk_cycles < 0))) {
+        return false;
+    }
+
+    tlb_destroy(context->tlb);
+    context->tlb = NULL;
+    if (! config) {
+        return true;
+    }
+
+    tlb_t* tlb = (tlb_t *) calloc(1, sizeof(tlb_t));
+    if (! tlb) {
+        return false;
+    }
+    tlb->config = *config;
+    tlb->set_count = config->entries / config->ways;
+    tlb->tag = (uint64_t *) calloc(config->entries, sizeof(uint64_t));
+    tlb->frame = (uint32_t *) calloc(config->entries, sizeof(uint32_t));
+    tlb->last_used = (uint64_t *) calloc(config->entries, sizeof(uint64_t));
+    if (! tlb->tag || ! tlb->frame || ! tlb->last_used) {
+        tlb_destroy(tlb);
+        return false;
+    }
+    tlb->seed = 1;
+    context->tlb = tlb;
+    return true;
+}
+
+bool page_swap_tlb_stats(const page_swap_t* const context, page_swap_tlb_stats_t* const stats) {
+    if (! context || ! context->tlb || ! stats) {
+        return false;
+    }
+    const tlb_t* tlb = context->tlb;
+    *stats = tlb->stats;
+    //every lookup pays for the TLB, a miss walks the page table as well
+    stats->hit_rate = stats->lookups ? (double) stats->hits / stats->lookups : 0;
+    stats->translation_cycles = stats->lookups ? tlb->config.hit_cycles
+        + (double) stats->misses / stats->lookups * tlb->config.walk_cycles : 0;
+    return true;
+}
+
+/*
+ * HELPER FUNCTION
+ * Splits the huge page holding a page of process back into base pages
+ * */
+static void demote_region(page_swap_t* const context, const size_t process, const unsigned int page_number) {
+    const unsigned int first = page_number - page_number % context->huge_span;
+    tlb_invalidate(context, process, first);
+    for (size_t i = 0; i < context->huge_span; ++i) {
+        context->page_tables[process].entries[first + i].huge = 0;
+    }
+    ++context->huge_stats.demotions;
+    --context->huge_stats.huge_pages;
+}
+
+//key of the page a frame holds in the list policies, a shared frame goes by its owner
+static uint32_t frame_key(const page_swap_t* const context, const uint32_t frame) {
+    return context->frame_table.owner[frame] * context->page_count + context->frame_table.page_table_idx[frame];
+}
+
+/*
+ * HELPER FUNCTIONS
+ * Take processes off a shared frame. When the owner leaves, another process
+ * mapping the frame takes it over
+ * */
+static void drop_shared_mapping(page_swap_t* const context, const size_t process, const unsigned int page_number) {
+    page_t* page = &context->page_tables[process].entries[page_number];
+    const uint32_t frame = page->frame_table_idx;
+    lock_page(context, process, page_number);
+    page->valid = 0;
+    page->cow = 0;
+    unlock_page(context, process, page_number);
+    tlb_invalidate(context, process, page_number);
+    --context->frame_table.sharers[frame];
+
+    for (size_t other = 0; context->frame_table.owner[frame] == process && other < context->process_count; ++other) {
+        if (frame_mapped_by(context, frame, other)) {
+            if (context->list_policy) {
+                list_policy_rename(context->list_policy, frame_key(context, frame), other * context->page_count + page_number);
+            }
+            context->frame_table.owner[frame] = other;
+            --context->processes[process].frames_held;
+            ++context->processes[other].frames_held;
+        }
+    }
+}
+
+//leaves the owner as the only process mapping the frame, a dirty frame is written
+//to the back store page of every process dropped. Returns false when a write fails
+static bool unshare_frame(page_swap_t* const context, const uint32_t frame) {
+    const uint32_t owner = context->frame_table.owner[frame];
+    const unsigned int page_number = context->frame_table.page_table_idx[frame];
+    for (size_t process = 0; context->frame_table.sharers[frame] > 1 && process < context->process_count; ++process) {
+        if (process == owner || ! frame_mapped_by(context, frame, process)) {
+            continue;
+        }
+        if (frame_flag(context->frame_table.dirty, frame) && ! write_page(context, process, frame_bytes(context, frame), page_number)) {
+            return false;
+        }
+        drop_shared_mapping(context, process, page_number);
+    }
+    return true;
+}
+
+/*
+ * HELPER FUNCTION
+ * Loads a page of process into the victim frame and updates the tables. The data
+ * comes from copy when it is not NULL, from the pool or back store otherwise.
+ * Returns false on failure
+ * */
+static bool load_page(page_swap_t* const context, const size_t process, const uint16_t page_number,
+        const uint32_t victimFrame, const size_t clock_time, const unsigned char* const copy) {
+    frame_table_t* frame = &context->frame_table;
+    unsigned char* data = frame_bytes(context, victimFrame);
+
+    //get victim page number
+    int victimPage = frame->page_table_idx[victimFrame];
+    uint32_t victimProcess = frame->owner[victimFrame];
+
+    //replacing any part of a huge page splits it
+    if (context->page_tables[victimProcess].entries[victimPage].huge) {
+        demote_region(context, victimProcess, victimPage);
+    }
+
+    //every other process sharing the frame loses the page as well
+    if (frame->sharers[victimFrame] > 1 && ! unshare_frame(context, victimFrame)) {
+        printf("Failed to write to backing store.\n");
+        return false;
+    }
+
+    //invalidate old page belonging to the victimized frame before its data goes
+    lock_page(context, victimProcess, victimPage);
+    context->page_tables[victimProcess].entries[victimPage].valid = 0;
+    context->page_tables[victimProcess].entries[victimPage].cow = 0;
+    unlock_page(context, victimProcess, victimPage);
+    tlb_invalidate(context, victimProcess, victimPage);
+
+    instrument_count(context, COUNT_EVICTION);
+    const uint64_t io_start = instrument_now(context);
+
+    //in zero copy mode the frame already is the page in the back store, only the tables change
+    if (context->store_view) {
+        mark_clean(context, victimFrame);
+    //put victim data in backing store, a clean victim already matches it
+    } else if (frame_flag(frame->dirty, victimFrame)) {
+        //a compressed copy in the pool saves the write
+        if (context->pool && pool_store(context, victimProcess, victimPage, data)) {
+            mark_clean(context, victimFrame);
+        } else if (write_page(context, victimProcess, data, victimPage)) {
+            mark_clean(context, victimFrame);
+            ++context->processes[process].fault_writebacks;
+        } else {
+            printf("Failed to write to backing store.\n");
+            return false;
+        }
+    }
+
+    //grab new data from the pool or the backing store and place in victim frame,
+    //a page taken out of the pool is newer than its back store copy
+    const bool from_pool = ! copy && pool_load(context, process, page_number, data, true);
+    if (copy) {
+        memcpy(data, copy, DATA_BLOCK_SIZE);
+    } else if (! from_pool && ! context->store_view && ! read_page(context, process, data, page_number)) {
+        printf("Failed to read from backing store.\n");
+        return false;
+    }
+    instrument_latency(context, LATENCY_IO, io_start);
+
+    //readahead that was never used means the window is too large
+    if (frame_flag(frame->prefetched, victimFrame)) {
+        set_frame_flag(frame->prefetched, victimFrame, 0);
+        context->processes[victimProcess].readahead_window /= 2;
+    }
+
+    //update victim frame page number
+    frame->page_table_idx[victimFrame] = page_number;
+    frame->owner[victimFrame] = process;
+    --context->processes[victimProcess].frames_held;
+    ++context->processes[process].frames_held;
+
+    //mark access bit on victim frame
+    set_frame_flag(frame->access_bit, victimFrame, 1);
+    frame->last_used[victimFrame] = clock_time;
+    if (from_pool) {
+        mark_dirty(context, victimFrame);
+    }
+
+    if (context->map_on_fault) {
+        lock_page(context, process, page_number);
+        context->page_tables[process].entries[page_number].frame_table_idx = victimFrame;
+        context->page_tables[process].entries[page_number].valid = 1;
+        unlock_page(context, process, page_number);
+    }
+
+    //newly loaded page goes behind every other frame with the same key
+    frame_buckets_remove(&context->lru_buckets, victimFrame);
+    frame_buckets_push(&context->lru_buckets, victimFrame, frame->access_tracking_byte[victimFrame]);
+    frame_buckets_remove(&context->lfu_buckets, victimFrame);
+    frame_buckets_push(&context->lfu_buckets, victimFrame, get_num_bits(frame->access_tracking_byte[victimFrame]));
+    frequency_reset(&context->frequencies, victimFrame);
+    frame_buckets_remove(&context->generations, victimFrame);
+    frame_buckets_push(&context->generations, victimFrame, context->youngest_generation % GENERATION_COUNT);
+    if (context->list_policy) {
+        list_policy_evict(context->list_policy, victimProcess * context->page_count + victimPage);
+        list_policy_insert(context->list_policy, frame_key(context, victimFrame));
+    }
+
+    return true;
+}
+
+//swaps entries a and b of an array of size byte entries
+static void swap_entries(void* const array, const uint32_t a, const uint32_t b, const size_t size) {
+    unsigned char held[sizeof(size_t)];
+    unsigned char* bytes = (unsigned char *) array;
+    memcpy(held, bytes + a * size, size);
+    memcpy(bytes + a * size, bytes + b * size, size);
+    memcpy(bytes + b * size, held, size);
+}
+
+/*
+ * HELPER FUNCTION
+ * Swaps the pages held by two frames, data and metadata, as compaction does
+ * when it moves pages to free up a contiguous block
+ * */
+static void exchange_frames(page_swap_t* const context, const uint32_t a, const uint32_t b) {
+    frame_table_t* frame = &context->frame_table;
+    page_t* page_a = &context->page_tables[frame->owner[a]].entries[frame->page_table_idx[a]];
+    page_t* page_b = &context->page_tables[frame->owner[b]].entries[frame->page_table_idx[b]];
+
+    tlb_invalidate(context, frame->owner[a], frame->page_table_idx[a]);
+    tlb_invalidate(context, frame->owner[b], frame->page_table_idx[b]);
+    lock_page(context, frame->owner[a], frame->page_table_idx[a]);
+    page_a->valid = 0;
+    unlock_page(context, frame->owner[a], frame->page_table_idx[a]);
+    lock_page(context, frame->owner[b], frame->page_table_idx[b]);
+    page_b->valid = 0;
+    unlock_page(context, frame->owner[b], frame->page_table_idx[b]);
+
+    //in zero copy mode the data stays with the page in the back store anyway
+    if (! context->store_view) {
+        unsigned char block[DATA_BLOCK_SIZE];
+        memcpy(block, frame_bytes(context, a), DATA_BLOCK_SIZE);
+        memcpy(frame_bytes(context, a), frame_bytes(context, b), DATA_BLOCK_SIZE);
+        memcpy(frame_bytes(context, b), block, DATA_BLOCK_SIZE);
+    }
+
+    swap_entries(frame->page_table_idx, a, b, sizeof(*frame->page_table_idx));
+    swap_entries(frame->owner, a, b, sizeof(*frame->owner));
+    swap_entries(frame->access_tracking_byte, a, b, sizeof(*frame->access_tracking_byte));
+    swap_entries(frame->access_bit, a, b, sizeof(*frame->access_bit));
+    swap_entries(frame->dirty, a, b, sizeof(*frame->dirty));
+    swap_entries(frame->last_used, a, b, sizeof(*frame->last_used));
+    swap_entries(frame->prefetched, a, b, sizeof(*frame->prefetched));
+    swap_entries(frame->sharers, a, b, sizeof(*frame->sharers));
+    swap_entries(frame->reserved, a, b, sizeof(*frame->reserved));
+
+    frame_buckets_remove(&context->lru_buckets, a);
+    frame_buckets_remove(&context->lru_buckets, b);
+    frame_buckets_push(&context->lru_buckets, a, frame->access_tracking_byte[a]);
+    frame_buckets_push(&context->lru_buckets, b, frame->access_tracking_byte[b]);
+    frame_buckets_remove(&context->lfu_buckets, a);
+    frame_buckets_remove(&context->lfu_buckets, b);
+    frame_buckets_push(&context->lfu_buckets, a, get_num_bits(frame->access_tracking_byte[a]));
+    frame_buckets_push(&context->lfu_buckets, b, get_num_bits(frame->access_tracking_byte[b]));
+    //the counts go with the pages, so a and b trade places in the frequency list
+    frequency_list_t* list = &context->frequencies;
+    const uint32_t node_a = list->node_of[a];
+    const uint32_t node_b = list->node_of[b];
+    frequency_unlink(list, a);
+    frequency_unlink(list, b);
+    frequency_append(list, a, node_b);
+    frequency_append(list, b, node_a);
+    const unsigned char generation_a = context->generations.key[a];
+    const unsigned char generation_b = context->generations.key[b];
+    frame_buckets_remove(&context->generations, a);
+    frame_buckets_remove(&context->generations, b);
+    frame_buckets_push(&context->generations, a, generation_b);
+    frame_buckets_push(&context->generations, b, generation_a);
+
+    lock_page(context, frame->owner[a], frame->page_table_idx[a]);
+    page_b->frame_table_idx = a;
+    page_b->valid = 1;
+    unlock_page(context, frame->owner[a], frame->page_table_idx[a]);
+    lock_page(context, frame->owner[b], frame->page_table_idx[b]);
+    page_a->frame_table_idx = b;
+    page_a->valid = 1;
+    unlock_page(context, frame->owner[b], frame->page_table_idx[b]);
+    ++context->huge_stats.compaction_moves;
+}
+
+/*
+ * HELPER FUNCTION
+ * Called after a fault of process. Once enough pages of the faulting region are
+ * resident the region becomes a huge page: the aligned block of frames holding
+ * most of it already in place is picked, resident pages are moved into their
+ * slots and missing ones are loaded. Blocks holding another huge page are out,
+ * when every block does the promotion fails for fragmentation. Under local
+ * replacement the loads count against the quota of process, a region that
+ * would take it over its quota stays in base pages
+ * */
+static void promote_region(page_swap_t* const context, const size_t process, const unsigned int page_number,
+        const size_t clock_time) {
+    const size_t span = context->huge_span;
+    const unsigned int first = page_number - page_number % span;
+    page_t* entries = context->page_tables[process].entries + first;
+    if (first + span > context->page_count || entries->huge) {
+        return;
+    }
+    size_t resident = 0;
+    for (size_t i = 0; i < span; ++i) {
+        resident += entries[i].valid;
+    }
+    if (resident < context->huge_promote_resident) {
+        return;
+    }
+    const process_t* promoting = &context->processes[process];
+    if (context->scope == PAGE_SWAP_LOCAL && promoting->frames_held + (span - resident) > promoting->quota) {
+        ++context->huge_stats.quota_refusals;
+        return;
+    }
+
+    const frame_table_t* frame = &context->frame_table;
+    size_t best_block = SIZE_MAX;
+    size_t best_in_place = 0;
+    for (size_t block = 0; block < context->frame_count; block += span) {
+        size_t in_place = 0;
+        size_t i = 0;
+        for (; i < span; ++i) {
+            const uint32_t owner = frame->owner[block + i];
+            const unsigned int held = frame->page_table_idx[block + i];
+            if (context->page_tables[owner].entries[held].huge) {
+                break;
+            }
+            in_place += owner == process && held == first + i;
+        }
+        if (i == span && (best_block == SIZE_MAX || in_place > best_in_place)) {
+            best_block = block;
+            best_in_place = in_place;
+        }
+    }
+    if (best_block == SIZE_MAX) {
+        ++context->huge_stats.promotion_failures;
+        return;
+    }
+
+    //line up the resident pages first so loading the rest cannot evict one of them
+    for (size_t i = 0; i < span; ++i) {
+        const uint32_t slot = best_block + i;
+        if (entries[i].valid && entries[i].frame_table_idx != slot) {
+            exchange_frames(context, slot, entries[i].frame_table_idx);
+        }
+    }
+    for (size_t i = 0; i < span; ++i) {
+        if (! entries[i].valid) {
+            if (! load_page(context, process, first + i, best_block + i, clock_time, NULL)) {
+                ++context->huge_stats.promotion_failures;
+                return;
+            }
+            ++context->huge_stats.fill_loads;
+        }
+    }
+
+    for (size_t i = 0; i < span; ++i) {
+        tlb_invalidate(context, process, first + i);
+        entries[i].huge = 1;
+    }
+    ++context->huge_stats.promotions;
+    ++context->huge_stats.huge_pages;
+}
+
+bool page_swap_set_huge_pages(page_swap_t* const context, const size_t span, const size_t promote_resident) {
+    if (! context || ! context->map_on_fault || (span && (span < 2 || (span & (span - 1))
+            || context->frame_count % span || promote_resident == 0 || promote_resident > span
+            || shared_mappings(context) > 0))) {
+        return false;
+    }
+
+    //the old span no longer describes the regions, split everything
+    for (size_t process = 0; process < context->process_count && context->huge_span; ++process) {
+        for (unsigned int page_number = 0; page_number < context->page_count; page_number += context->huge_span) {
+            if (context->page_tables[process].entries[page_number].huge) {
+                demote_region(context, process, page_number);
+            }
+        }
+    }
+
+    context->huge_span = span;
+    context->huge_promote_resident = promote_resident;
+    return true;
+}
+
+bool page_swap_huge_stats(const page_swap_t* const context, page_swap_huge_stats_t* const stats) {
+    if (! context || ! context->huge_span || ! stats) {
+        return false;
+    }
+    *stats = context->huge_stats;
+
+    //a block that is not a huge page but mixes regions needs compaction before it can be one
+    const frame_table_t* frame = &context->frame_table;
+    const size_t span = context->huge_span;
+    stats->fragmented_blocks = 0;
+    for (size_t block = 0; block < context->frame_count; block += span) {
+        const uint32_t owner = frame->owner[block];
+        const unsigned int region = frame->page_table_idx[block] / span;
+        if (context->page_tables[owner].entries[frame->page_table_idx[block]].huge) {
+            continue;
+        }
+        for (size_t i = 1; i < span; ++i) {
+            if (frame->owner[block + i] != owner || frame->page_table_idx[block + i] / span != region) {
+                ++stats->fragmented_blocks;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+/*
+ * HELPER FUNCTION
+ * Swaps the requested page of process into the victim frame and updates the tables.
+ * Returns the result object or NULL on failure
+ * */
+static page_request_result_t* swap_in_page(page_swap_t* const context, const size_t process, const uint16_t page_number,
+        const uint32_t victimFrame, const size_t clock_time) {
+    int victimPage = context->frame_table.page_table_idx[victimFrame];
+    uint32_t victimProcess = context->frame_table.owner[victimFrame];
+
+    if (! load_page(context, process, page_number, victimFrame, clock_time, NULL)) {
+        return NULL;
+    }
+
+    //return results object
+    page_request_result_t* page_req_result = (page_request_result_t *) malloc(sizeof(page_request_result_t));
+
+    if (! page_req_result) {
+        printf("Failed to allocate memory.\n");
+        return NULL;
+    }
+
+    page_req_result->page_requested = page_number;
+    page_req_result->frame_replaced = victimFrame;
+    page_req_result->page_replaced = victimPage;
+    page_req_result->process_replaced = victimProcess;
+
+    return page_req_result;
+}
+
+/*
+ * HELPER FUNCTION
+ * Shifts every access bit into its tracking byte and refiles the frame
+ * under its new tracking byte
+ * */
+static void age_frames(page_swap_t* const context) {
+    const size_t frame_count = context->frame_count;
+    unsigned char* trackingBytes = context->frame_table.access_tracking_byte;
+    unsigned char* accessBits = context->frame_table.access_bit;
+
+    if (! context->page_locks) {
+        //shift and tack the access bit on in one straight pass so the compiler can
+        //vectorize it over the dense metadata arrays
+        for (size_t i = 0; i < frame_count; ++i) {
+            trackingBytes[i] = (unsigned char)((trackingBytes[i] >> 1) | (accessBits[i] << 7));
+            accessBits[i] = 0;
+        }
+    } else {
+        //the fast path sets bits meanwhile, so they are swapped for zeros a word at a time.
+        //A bit set before the exchange counts in this span, one set after it in the next
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= frame_count; i += sizeof(uint64_t)) {
+            const uint64_t word = __atomic_exchange_n((uint64_t *) (accessBits + i), 0, __ATOMIC_RELAXED);
+            unsigned char taken[sizeof(uint64_t)];
+            memcpy(taken, &word, sizeof(word));
+            for (size_t j = 0; j < sizeof(uint64_t); ++j) {
+                trackingBytes[i + j] = (unsigned char)((trackingBytes[i + j] >> 1) | (taken[j] << 7));
+            }
+        }
+        for (; i < frame_count; ++i) {
+            const unsigned char accessBit = __atomic_exchange_n(&accessBits[i], 0, __ATOMIC_RELAXED);
+            trackingBytes[i] = (unsigned char)((trackingBytes[i] >> 1) | (accessBit << 7));
+        }
+    }
+
+    //refile only the frames whose tracking byte changed
+    for (size_t i = 0; i < frame_count; ++i) {
+        if (context->lru_buckets.key[i] != trackingBytes[i]) {
+            frame_buckets_move(&context->lru_buckets, i, trackingBytes[i]);
+            frame_buckets_move(&context->lfu_buckets, i, get_num_bits(trackingBytes[i]));
+        }
+    }
+}
+
+/*
+ * HELPER FUNCTIONS
+ * Generations of the generational policy. A referenced frame is only noted in
+ * a batch, the batch is moved to the youngest generation when it fills up or
+ * before a victim is picked, so the work follows the references rather than
+ * the size of the frame table. Each batch opens a new generation while fewer
+ * than GENERATION_COUNT are live
+ * */
+static void generation_flush(page_swap_t* const context) {
+    if (context->generation_batch_size == 0) {
+        return;
+    }
+    if (context->youngest_generation - context->oldest_generation + 1 < GENERATION_COUNT) {
+        ++context->youngest_generation;
+    }
+    const unsigned char youngest = context->youngest_generation % GENERATION_COUNT;
+    for (size_t i = 0; i < context->generation_batch_size; ++i) {
+        const uint32_t frame = context->generation_batch[i];
+        frame_buckets_remove(&context->generations, frame);
+        frame_buckets_push(&context->generations, frame, youngest);
+        context->generation_pending[frame] = 0;
+    }
+    context->generation_batch_size = 0;
+}
+
+static void generation_reference(page_swap_t* const context, const uint32_t frame) {
+    if (context->generation_pending[frame]) {
+        return;
+    }
+    context->generation_pending[frame] = 1;
+    context->generation_batch[context->generation_batch_size++] = frame;
+    if (context->generation_batch_size == GENERATION_BATCH) {
+        generation_flush(context);
+    }
+}
+
+// Picks the frame to evict on a page fault from the frames that are candidates
+typedef uint32_t (*select_victim_t)(page_swap_t* const context, const size_t clock_time, const uint32_t candidates);
+
+//sets or clears the reserved byte of frame, keeping frames_reserved in step
+static void reserve_frame(page_swap_t* const context, const uint32_t frame, const bool reserved) {
+    if (context->frame_table.reserved[frame] != reserved) {
+        context->frame_table.reserved[frame] = reserved;
+        if (reserved) {
+            ++context->frames_reserved;
+        } else {
+            --context->frames_reserved;
+        }
+    }
+}
+
+/*
+ * HELPER FUNCTION
+ * Called on a fault of process. When the fault continues a sequential run in its
+ * region, the window grows (doubling up to readahead_max) and the pages after the
+ * faulting one are loaded into frames picked by the same policy. The faulting
+ * frame and the frames filled so far are reserved until the batch is done, so
+ * the batch never evicts its own pages
+ * */
+static void read_ahead(page_swap_t* const context, const size_t process, const uint16_t page_number,
+        const size_t clock_time, select_victim_t select_victim) {
+    process_t* owner = &context->processes[process];
+    size_t* stream = &owner->stream_next[page_number / READAHEAD_REGION_PAGES];
+
+    if (*stream != page_number) {
+        //not sequential, just remember where a run would go next
+        *stream = NO_STREAM;
+        if (page_number + 1u < context->page_count) {
+            owner->stream_next[(page_number + 1u) / READAHEAD_REGION_PAGES] = page_number + 1u;
+        }
+        return;
+    }
+    *stream = NO_STREAM;
+
+    owner->readahead_window = owner->readahead_window ? owner->readahead_window * 2 : 1;
+    if (owner->readahead_window > context->readahead_max) {
+        owner->readahead_window = context->readahead_max;
+    }
+
+    page_t* entries = context->page_tables[process].entries;
+    reserve_frame(context, entries[page_number].frame_table_idx, true);
+    size_t next = page_number + 1u;
+    for (; next <= page_number + owner->readahead_window && next < context->page_count; ++next) {
+        if (entries[next].valid) {
+            continue;
+        }
+        uint32_t victimFrame = select_victim(context, clock_time, victim_candidates(context, process));
+        if (victimFrame == NO_FRAME || ! load_page(context, process, next, victimFrame, clock_time, NULL)) {
+            break;
+        }
+        reserve_frame(context, victimFrame, true);
+        set_frame_flag(context->frame_table.prefetched, victimFrame, 1);
+        ++owner->prefetches;
+    }
+
+    //every reserved frame holds a page of the batch
+    for (size_t page = page_number; page < next && page < context->page_count; ++page) {
+        if (entries[page].valid) {
+            reserve_frame(context, entries[page].frame_table_idx, false);
+        }
+    }
+
+    //the run continues with the first page that was not read ahead
+    if (next < context->page_count) {
+        owner->stream_next[next / READAHEAD_REGION_PAGES] = next;
+    }
+}
+
+/*
+ * HELPER FUNCTION
+ * First write of process to a page marked copy on write. While other processes
+ * still map its frame the page is copied into a frame select_victim picks,
+ * otherwise the process just keeps the frame. Returns false on failure
+ * */
+static bool copy_on_write(page_swap_t* const context, const size_t process, const uint16_t page_number,
+        const size_t clock_time, select_victim_t select_victim) {
+    page_t* page = &context->page_tables[process].entries[page_number];
+    const uint32_t shared = page->frame_table_idx;
+    if (context->frame_table.sharers[shared] == 1) {
+        page->cow = 0;
+        ++context->cow_stats.copies_avoided;
+        return true;
+    }
+
+    //the victim may be the shared frame itself, so the data is kept aside first
+    unsigned char copy[DATA_BLOCK_SIZE];
+    memcpy(copy, frame_bytes(context, shared), DATA_BLOCK_SIZE);
+    const uint32_t victimFrame = select_victim(context, clock_time, victim_candidates(context, process));
+    if (victimFrame == NO_FRAME) {
+        return false;
+    }
+    drop_shared_mapping(context, process, page_number);
+    if (! load_page(context, process, page_number, victimFrame, clock_time, copy)) {
+        return false;
+    }
+    ++context->cow_stats.pages_copied;
+    return true;
+}
+
+bool page_swap_fork(page_swap_t* const context, const size_t parent, const size_t child) {
+    if (! context || ! context->bs || ! context->map_on_fault || context->store_view || context->huge_span
+            || parent >= context->process_count || child >= context->process_count || parent == child
+            || context->processes[child].frames_held > 0) {
+        return false;
+    }
+    for (size_t page_number = 0; page_number < context->page_count; ++page_number) {
+        if (context->page_tables[child].entries[page_number].valid) {
+            return false;
+        }
+    }
+
+    unsigned char data[DATA_BLOCK_SIZE];
+    for (unsigned int page_number = 0; page_number < context->page_count; ++page_number) {
+        page_t* from = &context->page_tables[parent].entries[page_number];
+        page_t* to = &context->page_tables[child].entries[page_number];
+        //a pooled copy of the page of the child is older than what it inherits
+        pool_load(context, child, page_number, data, true);
+        if (from->valid) {
+            to->frame_table_idx = from->frame_table_idx;
+            to->valid = 1;
+            to->cow = 1;
+            from->cow = 1;
+            ++context->frame_table.sharers[from->frame_table_idx];
+            //the back store page of the child does not hold the data yet
+            mark_dirty(context, from->frame_table_idx);
+            continue;
+        }
+
+        //in lazy mode two pages that were never written back or pooled both hold the initial data
+        const size_t parent_key = parent * context->page_count + page_number;
+        const size_t child_key = child * context->page_count + page_number;
+        if (context->materialized && ! (context->materialized[parent_key / 64] >> (parent_key % 64) & 1)
+                && ! (context->materialized[child_key / 64] >> (child_key % 64) & 1)
+                && ! (context->pool && context->pool->slot_of[parent_key] != NO_SLOT)) {
+            continue;
+        }
+        if (! (pool_load(context, parent, page_number, data, false) || read_page(context, parent, data, page_number))
+                || ! write_page(context, child, data, page_number)) {
+            return false;
+        }
+    }
+    ++context->cow_stats.forks;
+    return true;
+}
+
+bool page_swap_cow_stats(const page_swap_t* const context, page_swap_cow_stats_t* const stats) {
+    if (! context || ! context->bs || ! stats) {
+        return false;
+    }
+    *stats = context->cow_stats;
+    stats->shared_frames = 0;
+    for (uint32_t frame = 0; frame < context->frame_count; ++frame) {
+        stats->shared_frames += context->frame_table.sharers[frame] > 1;
+    }
+    stats->shared_mappings = shared_mappings(context);
+    stats->memory_saved_bytes = stats->shared_mappings * DATA_BLOCK_SIZE;
+    return true;
+}
+
+/*
+ * HELPER FUNCTION
+ * Handles one page reference of process. On a fault the victim comes from select_victim.
+ * A write reference marks the frame holding the page dirty. Policies that
+ * rank frames by tracking byte also need the periodic aging sweep, only
+ * exact LFU keeps counting hits, only MGLRU moves hit frames between generations
+ * and only ARC, 2Q and LIRS move hit pages between their lists
+ * */
+static page_request_result_t* request_page(page_swap_t* const context, const size_t process, const uint16_t page_number,
+        const size_t clock_time, const page_swap_policy_t policy, select_victim_t select_victim, const bool write) {
+    if (process >= context->process_count || page_number >= context->page_count) {
+        return NULL;
+    }
+    page_t* page = &context->page_tables[process].entries[page_number];
+    const bool aging = policy == PAGE_SWAP_LFU || policy == PAGE_SWAP_ALRU;
+    const bool exact_counts = policy == PAGE_SWAP_LFU_EXACT;
+    const bool listed = is_list_policy(policy);
+    __atomic_fetch_add(&context->processes[process].references, 1, __ATOMIC_RELAXED);
+    if (exact_counts && context->frequencies.decay_interval > 0 && --context->frequencies.until_decay == 0) {
+        frequency_decay(&context->frequencies);
+        context->frequencies.until_decay = context->frequencies.decay_interval;
+    }
+
+    //the result to return
+    //init to NULL until the page is validated or invalidated
+	page_request_result_t* page_req_result = NULL;
+
+    //check the TLB, then walk the page table to see if page number is valid
+    const uint32_t tlb_frame = tlb_lookup(context, process, page_number);
+    bool valid = tlb_frame != NO_FRAME || page->valid;
+    if (tlb_frame == NO_FRAME && valid) {
+        tlb_fill(context, process, page_number, page->frame_table_idx);
+    }
+
+    //if not valid
+    if (! valid) {
+        //Page is invalid, so find victim, swap data and update tables
+        ++context->processes[process].faults;
+        instrument_count(context, COUNT_FAULT);
+        const uint64_t fault_start = instrument_now(context);
+        if (listed) {
+            list_policy_miss(context->list_policy, process * context->page_count + page_number);
+        }
+        uint32_t victimFrame = select_victim(context, clock_time, victim_candidates(context, process));
+        instrument_latency(context, LATENCY_VICTIM, fault_start);
+        //every frame the fault may take is reserved
+        if (victimFrame == NO_FRAME) {
+            return NULL;
+        }
+        page_req_result = swap_in_page(context, process, page_number, victimFrame, clock_time);
+        if (! page_req_result) {
+            return NULL;
+        }
+        if (write) {
+            mark_dirty(context, victimFrame);
+        }
+        if (context->huge_span > 0) {
+            promote_region(context, process, page_number, clock_time);
+        }
+        //the retried access translates the new mapping
+        if (page->valid) {
+            tlb_fill(context, process, page_number, page->frame_table_idx);
+        }
+
+        if (context->readahead_max > 0) {
+            read_ahead(context, process, page_number, clock_time, select_victim);
+        }
+        instrument_latency(context, LATENCY_FAULT, fault_start);
+    }
+
+    //update access bit of frame table for valid entries too
+    if (valid) {
+        if (write && page->cow && ! copy_on_write(context, process, page_number, clock_time, select_victim)) {
+            return NULL;
+        }
+        int frame = page->frame_table_idx;
+        set_frame_flag(context->frame_table.access_bit, frame, 1); //set access bit
+        instrument_count(context, COUNT_HIT);
+        if (exact_counts) {
+            frequency_touch(&context->frequencies, frame);
+        }
+        if (policy == PAGE_SWAP_MGLRU) {
+            generation_reference(context, frame);
+        }
+        if (listed) {
+            list_policy_hit(context->list_policy, frame_key(context, frame));
+        }
+        if (frame_flag(context->frame_table.prefetched, frame)) {
+            set_frame_flag(context->frame_table.prefetched, frame, 0);
+            ++context->processes[process].prefetch_hits;
+        }
+        if (write) {
+            mark_dirty(context, frame);
+        }
+    }
+
+    //update access byte if it is time to do so
+    if (aging && clock_time % 99 == 0) {
+        age_frames(context);
+    }
+
+	return page_req_result;
+}
+
+/*
+ * ALRU IMPLEMENTATION
+ * The victim is the frame with the smallest tracking byte
+ * */
+static uint32_t select_lru_victim(page_swap_t* const context, const size_t clock_time, const uint32_t candidates) {
+    (void)clock_time;
+    return frame_buckets_min_candidate(context, &context->lru_buckets, candidates);
+}
+
+page_request_result_t* approx_least_recently_used (const uint16_t page_number, const size_t clock_time) {
+    return page_swap_request(&ps, PAGE_SWAP_ALRU, page_number, clock_time, false);
+}
+
+page_request_result_t* approx_least_recently_used_write (const uint16_t page_number, const size_t clock_time) {
+    return page_swap_request(&ps, PAGE_SWAP_ALRU, page_number, clock_time, true);
+}
+
+/*
+ * LFU IMPLEMENTATION
+ * The victim is the frame with the fewest bits set in its tracking byte
+ * */
+static uint32_t select_lfu_victim(page_swap_t* const context, const size_t clock_time, const uint32_t candidates) {
+    (void)clock_time;
+    return frame_buckets_min_candidate(context, &context->lfu_buckets, candidates);
+}
+
+page_request_result_t* least_frequently_used (const uint16_t page_number, const size_t clock_time) {
+    return page_swap_request(&ps, PAGE_SWAP_LFU, page_number, clock_time, false);
+}
+
+page_request_result_t* least_frequently_used_write (const uint16_t page_number, const size_t clock_time) {
+    return page_swap_request(&ps, PAGE_SWAP_LFU, page_number, clock_time, true);
+}
+
+/*
+ * EXACT LFU IMPLEMENTATION
+ * The victim is the oldest frame among those with the smallest reference count.
+ * A page that just faulted in is alone at count 1, so a readahead batch relies
+ * on its frame being reserved to keep from taking it
+ * */
+static uint32_t select_lfu_exact_victim(page_swap_t* const context, const size_t clock_time, const uint32_t candidates) {
+    (void)clock_time;
+    const frequency_list_t* list = &context->frequencies;
+    for (uint32_t node = list->lowest; node != NO_FRAME; node = list->higher[node]) {
+        for (uint32_t frame = list->head[node]; frame != NO_FRAME; frame = list->next[frame]) {
+            if (frame_is_candidate(context, frame, candidates)) {
+                return frame;
+            }
+        }
+    }
+    return NO_FRAME;
+}
+
+bool page_swap_set_lfu_decay(page_swap_t* const context, const size_t interval) {
+    if (! context) {
+        return false;
+    }
+    context->frequencies.decay_interval = interval;
+    context->frequencies.until_decay = interval;
+    return true;
+}
+
+/*
+ * GENERATIONAL LRU IMPLEMENTATION
+ * The victim is the oldest candidate of the oldest generation, after the frames
+ * referenced since the last batch have moved to the youngest one. An emptied
+ * oldest generation retires
+ * */
+static uint32_t select_generation_victim(page_swap_t* const context, const size_t clock_time, const uint32_t candidates) {
+    (void)clock_time;
+    generation_flush(context);
+
+    frame_buckets_t* generations = &context->generations;
+    while (context->oldest_generation < context->youngest_generation
+            && generations->head[context->oldest_generation % GENERATION_COUNT] == NO_FRAME) {
+        ++context->oldest_generation;
+    }
+    for (uint64_t generation = context->oldest_generation; generation <= context->youngest_generation; ++generation) {
+        for (uint32_t frame = generations->head[generation % GENERATION_COUNT]; frame != NO_FRAME;
+                frame = generations->next[frame]) {
+            if (frame_is_candidate(context, frame, candidates)) {
+                return frame;
+            }
+        }
+    }
+    return NO_FRAME;
+}
+
+/*
+ * ARC, 2Q AND LIRS IMPLEMENTATION
+ * The list policies run on the pages of every process, keyed process * page_count
+ * + page. The lists are built from the resident frames when one of them runs
+ * first or after another one of them, as if those pages were referenced once in
+ * frame order. From then on load_page keeps them in step whatever policy runs.
+ * The victim is the frame holding the key the policy picks among the candidates
+ * */
+typedef struct {
+    const page_swap_t* context;
+    uint32_t candidates;
+}key_filter_t;
+
+static bool key_is_candidate(const void* filter, const uint32_t key) {
+    const key_filter_t* taking = (const key_filter_t *) filter;
+    const page_swap_t* context = taking->context;
+    const uint32_t frame = context->page_tables[key / context->page_count].entries[key % context->page_count].frame_table_idx;
+    return frame_is_candidate(context, frame, taking->candidates);
+}
+
+static uint32_t select_list_victim(page_swap_t* const context, const size_t clock_time, const uint32_t candidates) {
+    (void)clock_time;
+    key_filter_t filter = {context, candidates};
+    const uint32_t key = list_policy_victim(context->list_policy, key_is_candidate, &filter);
+    if (key == NO_PAGE) {
+        return NO_FRAME;
+    }
+    return context->page_tables[key / context->page_count].entries[key % context->page_count].frame_table_idx;
+}
+
+//the lists need a page table entry for every resident page. Returns false on failure
+static bool list_policy_start(page_swap_t* const context, const page_swap_policy_t policy) {
+    if (context->list_policy && context->list_policy->kind == policy) {
+        return true;
+    }
+    if (! context->map_on_fault) {
+        return false;
+    }
+    if (context->list_policy) {
+        list_policy_destroy(context->list_policy);
+        free(context->list_policy);
+        context->list_policy = NULL;
+    }
+
+    list_policy_t* lists = (list_policy_t *) malloc(sizeof(list_policy_t));
+    if (! lists || ! list_policy_create(lists, policy, context->process_count * context->page_count, context->frame_count)) {
+        if (lists) {
+            list_policy_destroy(lists);
+        }
+        free(lists);
+        return false;
+    }
+    for (uint32_t frame = 0; frame < context->frame_count; ++frame) {
+        list_policy_insert(lists, frame_key(context, frame));
+    }
+    context->list_policy = lists;
+    return true;
+}
+
+/*
+ * CLOCK IMPLEMENTATION
+ * Second chance: the hand sweeps the frame table clearing access bits and
+ * stops at the first frame that was not referenced since the last pass.
+ * Frames that are not candidates are passed over untouched
+ * */
+static uint32_t select_clock_victim(page_swap_t* const context, const size_t clock_time, const uint32_t candidates) {
+    (void)clock_time;
+
+    //at most one full turn clears every bit, so the second turn stops unless nothing is a candidate
+    for (size_t i = 0; i < 2 * context->frame_count; ++i) {
+        uint32_t frame = context->clock_hand;
+        context->clock_hand = (context->clock_hand + 1) % context->frame_count;
+
+        if (! frame_is_candidate(context, frame, candidates)) {
+            continue;
+        }
+        if (! frame_flag(context->frame_table.access_bit, frame)) {
+            return frame;
+        }
+        set_frame_flag(context->frame_table.access_bit, frame, 0);
+    }
+    return NO_FRAME;
+}
+
+page_request_result_t* clock_second_chance (const uint16_t page_number, const size_t clock_time) {
+    return page_swap_request(&ps, PAGE_SWAP_CLOCK, page_number, clock_time, false);
+}
+
+page_request_result_t* clock_second_chance_write (const uint16_t page_number, const size_t clock_time) {
+    return page_swap_request(&ps, PAGE_SWAP_CLOCK, page_number, clock_time, true);
+}
+
+/*
+ * WSCLOCK IMPLEMENTATION
+ * Like CLOCK, but a referenced frame records the time it was seen and only
+ * frames unused for longer than WORKING_SET_WINDOW are evicted. Old dirty
+ * frames are cleaned on the way past so a later pass can take them.
+ * When the whole table is in the working set the oldest frame is taken
+ * */
+static uint32_t select_ws_clock_victim(page_swap_t* const context, const size_t clock_time, const uint32_t candidates) {
+    frame_table_t* frame_table = &context->frame_table;
+    uint32_t oldestFrame = NO_FRAME;
+
+    //first turn clears access bits and cleans old frames, second turn finds them clean
+    for (size_t i = 0; i < 2 * context->frame_count; ++i) {
+        uint32_t frame = context->clock_hand;
+        context->clock_hand = (context->clock_hand + 1) % context->frame_count;
+
+        if (! frame_is_candidate(context, frame, candidates)) {
+            continue;
+        }
+
+        if (frame_flag(frame_table->access_bit, frame)) {
+            //still in the working set
+            set_frame_flag(frame_table->access_bit, frame, 0);
+            frame_table->last_used[frame] = clock_time;
+            continue;
+        }
+
+        if (oldestFrame == NO_FRAME || frame_table->last_used[frame] < frame_table->last_used[oldestFrame]) {
+            oldestFrame = frame;
+        }
+
+        if (clock_time - frame_table->last_used[frame] > WORKING_SET_WINDOW) {
+            if (! frame_flag(frame_table->dirty, frame)) {
+                return frame;
+            }
+
+            //write it back now and take it on a later pass if nothing clean turns up
+            clean_frame(context, frame);
+        }
+    }
+
+    if (oldestFrame != NO_FRAME) {
+        context->clock_hand = (oldestFrame + 1) % context->frame_count;
+    }
+    return oldestFrame;
+}
+
+page_request_result_t* working_set_clock (const uint16_t page_number, const size_t clock_time) {
+    return page_swap_request(&ps, PAGE_SWAP_WSCLOCK, page_number, clock_time, false);
+}
+
+page_request_result_t* working_set_clock_write (const uint16_t page_number, const size_t clock_time) {
+    return page_swap_request(&ps, PAGE_SWAP_WSCLOCK, page_number, clock_time, true);
+}
+
+/*
+ * HELPER FUNCTION
+ * Concurrent mode fast path. Handles a reference that hits and changes nothing
+ * but the access bit while holding only the page lock. Anything else, a fault,
+ * an aging tick, a first write or a prefetched frame, returns false and takes
+ * the context lock. A bit set here during an aging sweep lands in either interval
+ * */
+static bool concurrent_hit(page_swap_t* const context, const size_t process, const uint16_t page_number,
+        const size_t clock_time, const bool aging, const bool write) {
+    if (process >= context->process_count || page_number >= context->page_count
+            || (aging && clock_time % 99 == 0)) {
+        return false;
+    }
+
+    lock_page(context, process, page_number);
+    const page_t* page = &context->page_tables[process].entries[page_number];
+    const uint32_t frame = page->frame_table_idx;
+    const bool hit = page->valid && ! frame_flag(context->frame_table.prefetched, frame)
+        && (! write || (frame_flag(context->frame_table.dirty, frame) && ! page->cow));
+    if (hit) {
+        set_frame_flag(context->frame_table.access_bit, frame, 1);
+        __atomic_fetch_add(&context->processes[process].references, 1, __ATOMIC_RELAXED);
+        instrument_count(context, COUNT_HIT);
+    }
+    unlock_page(context, process, page_number);
+
+    return hit;
+}
+
+page_request_result_t* page_swap_process_request(page_swap_t* const context, const page_swap_policy_t policy,
+        const size_t process, const uint16_t page_number, const size_t clock_time, const bool write) {
+    if (! context || ! context->bs) {
+        return NULL;
+    }
+
+    //the TLB, exact counts, generation batches and page lists are shared state, with any
+    //of them every reference takes the context lock
+    const bool aging = policy == PAGE_SWAP_LFU || policy == PAGE_SWAP_ALRU;
+    if (context->page_locks && ! context->tlb && policy != PAGE_SWAP_LFU_EXACT && policy != PAGE_SWAP_MGLRU
+            && ! is_list_policy(policy) && concurrent_hit(context, process, page_number, clock_time, aging, write)) {
+        return NULL;
+    }
+
+    page_request_result_t* page_req_result = NULL;
+    pthread_mutex_lock(&context->lock);
+    switch (policy) {
+        case PAGE_SWAP_LFU:
+            page_req_result = request_page(context, process, page_number, clock_time, policy, select_lfu_victim, write);
+            break;
+        case PAGE_SWAP_ALRU:
+            page_req_result = request_page(context, process, page_number, clock_time, policy, select_lru_victim, write);
+            break;
+        case PAGE_SWAP_CLOCK:
+            page_req_result = request_page(context, process, page_number, clock_time, policy, select_clock_victim, write);
+            break;
+        case PAGE_SWAP_WSCLOCK:
+            page_req_result = request_page(context, process, page_number, clock_time, policy, select_ws_clock_victim, write);
+            break;
+        case PAGE_SWAP_LFU_EXACT:
+            page_req_result = request_page(context, process, page_number, clock_time, policy, select_lfu_exact_victim, write);
+            break;
+        case PAGE_SWAP_MGLRU:
+            page_req_result = request_page(context, process, page_number, clock_time, policy, select_generation_victim, write);
+            break;
+        case PAGE_SWAP_ARC:
+        case PAGE_SWAP_2Q:
+        case PAGE_SWAP_LIRS:
+            if (list_policy_start(context, policy)) {
+                page_req_result = request_page(context, process, page_number, clock_time, policy, select_list_victim, write);
+            }
+            break;
+        case PAGE_SWAP_OPT:
+            //needs the references still to come, see page_swap_sweep
+            break;
+    }
+    pthread_mutex_unlock(&context->lock);
+    return page_req_result;
+}
+
+/*
+ * FLUSHER IMPLEMENTATION
+ * Background thread that sleeps until the clean frames drop below the low
+ * watermark, then writes dirty frames back in frame order until the high
+ * watermark is reached. A failed write leaves its frame dirty and ends the
+ * pass until the flusher is woken up again
+ * */
+
+/*
+ * HELPER FUNCTION
+ * Writes a dirty frame back with the context lock released, so faults go on
+ * meanwhile. The frame is copied and kept out of victim selection for the
+ * write, then marked clean only if it still holds the page and the data
+ * written. Shared frames, zero copy and a first write in lazy mode change
+ * more than the block and are cleaned under the lock. Called and returns
+ * with the lock held, returns false when the write failed
+ * */
+static bool flush_frame(page_swap_t* const context, const uint32_t frame) {
+    const uint32_t owner = context->frame_table.owner[frame];
+    const unsigned int page_number = context->frame_table.page_table_idx[frame];
+    const size_t key = owner * context->page_count + page_number;
+    if (context->store_view || context->frame_table.sharers[frame] > 1
+            || (context->materialized && ! (context->materialized[key / 64] >> (key % 64) & 1))) {
+        return clean_frame(context, frame);
+    }
+
+    unsigned char data[DATA_BLOCK_SIZE];
+    memcpy(data, frame_bytes(context, frame), DATA_BLOCK_SIZE);
+    context->flushing_frame = frame;
+    pthread_mutex_unlock(&context->lock);
+    const bool written = write_page(context, owner, data, page_number);
+    pthread_mutex_lock(&context->lock);
+    context->flushing_frame = NO_FRAME;
+
+    if (written && context->frame_table.owner[frame] == owner && context->frame_table.page_table_idx[frame] == page_number
+            && ! memcmp(data, frame_bytes(context, frame), DATA_BLOCK_SIZE)) {
+        mark_clean(context, frame);
+    }
+    return written;
+}
+
+static void* flusher_main(void* arg) {
+    page_swap_t* context = (page_swap_t *) arg;
+
+    pthread_mutex_lock(&context->lock);
+    while (! context->flusher_stop) {
+        if (context->frame_count - context->dirty_frames >= context->flush_low) {
+            pthread_cond_wait(&context->flush_wanted, &context->lock);
+            continue;
+        }
+
+        while (! context->flusher_stop && context->dirty_frames > 0
+                && context->frame_count - context->dirty_frames < context->flush_high) {
+            uint32_t frame = context->flush_hand;
+            context->flush_hand = (context->flush_hand + 1) % context->frame_count;
+            if (! frame_flag(context->frame_table.dirty, frame)) {
+                continue;
+            }
+
+            if (! flush_frame(context, frame)) {
+                pthread_cond_wait(&context->flush_wanted, &context->lock);
+                break;
+            }
+            ++context->flusher_writebacks;
+        }
+    }
+    pthread_mutex_unlock(&context->lock);
+
+    return NULL;
+}
+
+bool page_swap_start_flusher(page_swap_t* const context, const size_t low_watermark, const size_t high_watermark) {
+    if (! context || context->flusher_running || low_watermark == 0 || low_watermark > high_watermark
+            || high_watermark > context->frame_count) {
+        return false;
+    }
+
+    context->flush_low = low_watermark;
+    context->flush_high = high_watermark;
+    context->flusher_stop = false;
+    if (pthread_create(&context->flusher, NULL, flusher_main, context) != 0) {
+        return false;
+    }
+    context->flusher_running = true;
+
+    //frames may already be dirty
+    pthread_mutex_lock(&context->lock);
+    pthread_cond_signal(&context->flush_wanted);
+    pthread_mutex_unlock(&context->lock);
+    return true;
+}
+
+void page_swap_stop_flusher(page_swap_t* const context) {
+    if (! context || ! context->flusher_running) {
+        return;
+    }
+
+    pthread_mutex_lock(&context->lock);
+    context->flusher_stop = true;
+    pthread_cond_signal(&context->flush_wanted);
+    pthread_mutex_unlock(&context->lock);
+
+    pthread_join(context->flusher, NULL);
+    context->flusher_running = false;
+}
+
+size_t page_swap_flusher_writebacks(const page_swap_t* const context) {
+    return context ? context->flusher_writebacks : 0;
+}
+
+page_request_result_t* page_swap_request(page_swap_t* const context, const page_swap_policy_t policy,
+        const uint16_t page_number, const size_t clock_time, const bool write) {
+    return page_swap_process_request(context, policy, 0, page_number, clock_time, write);
+}
+
+
+/*
+ * OPT IMPLEMENTATION
+ * Belady's optimal replacement over a known reference trace. A backward pass
+ * records where every reference is next used, then resident pages sit in a
+ * max heap keyed on that next use so the victim is always the heap root
+ * */
+#define PAGE_NUMBER_SPACE 65536 // every value a uint16_t page number can take
+#define NEVER_USED SIZE_MAX // next use of a page that is not referenced again
+
+typedef struct {
+	uint16_t* pages; // resident pages ordered as a max heap on next use
+	size_t* next_use; // next use of every page number while resident
+	int32_t* position; // heap slot of every page number, -1 when not resident
+	size_t size;
+}opt_heap_t;
+
+static void opt_heap_swap(opt_heap_t* heap, const size_t a, const size_t b) {
+    uint16_t page = heap->pages[a];
+    heap->pages[a] = heap->pages[b];
+    heap->pages[b] = page;
+    heap->position[heap->pages[a]] = a;
+    heap->position[heap->pages[b]] = b;
+}
+
+static void opt_heap_sift_up(opt_heap_t* heap, size_t slot) {
+    while (slot > 0) {
+        size_t parent = (slot - 1) / 2;
+        if (heap->next_use[heap->pages[parent]] >= heap->next_use[heap->pages[slot]]) {
+            break;
+        }
+        opt_heap_swap(heap, slot, parent);
+        slot = parent;
+    }
+}
+
+static void opt_heap_sift_down(opt_heap_t* heap, size_t slot) {
+    for (;;) {
+        size_t largest = slot;
+        size_t left = 2 * slot + 1;
+        size_t right = left + 1;
+
+        if (left < heap->size && heap->next_use[heap->pages[left]] > heap->next_use[heap->pages[largest]]) {
+            largest = left;
+        }
+        if (right < heap->size && heap->next_use[heap->pages[right]] > heap->next_use[heap->pages[largest]]) {
+            largest = right;
+        }
+        if (largest == slot) {
+            break;
+        }
+        opt_heap_swap(heap, slot, largest);
+        slot = largest;
+    }
+}
+
+size_t optimal_page_faults (const uint16_t* pages, const size_t count, const size_t frame_count) {
+    if (! pages || frame_count == 0) {
+        return SIZE_MAX;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    size_t faults = SIZE_MAX;
+    size_t* next_index = (size_t *) malloc(count * sizeof(size_t));
+    size_t* last_seen = (size_t *) malloc(PAGE_NUMBER_SPACE * sizeof(size_t));
+    opt_heap_t heap;
+    heap.pages = (uint16_t *) malloc(frame_count * sizeof(uint16_t));
+    heap.next_use = (size_t *) malloc(PAGE_NUMBER_SPACE * sizeof(size_t));
+    heap.position = (int32_t *) malloc(PAGE_NUMBER_SPACE * sizeof(int32_t));
+    heap.size = 0;
+
+    if (next_index && last_seen && heap.pages && heap.next_use && heap.position) {
+        //backward pass: where is each reference used next
+        for (size_t i = 0; i < PAGE_NUMBER_SPACE; ++i) {
+            last_seen[i] = NEVER_USED;
+            heap.position[i] = -1;
+        }
+        for (size_t i = count; i-- > 0;) {
+            next_index[i] = last_seen[pages[i]];
+            last_seen[pages[i]] = i;
+        }
+
+        faults = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const uint16_t page = pages[i];
+            heap.next_use[page] = next_index[i];
+
+            if (heap.position[page] >= 0) {
+                //hit, the page is only needed later now
+                opt_heap_sift_up(&heap, heap.position[page]);
+                continue;
+            }
+
+            ++faults;
+            if (heap.size == frame_count) {
+                //evict the page used furthest in the future
+                heap.position[heap.pages[0]] = -1;
+                heap.pages[0] = page;
+                heap.position[page] = 0;
+                opt_heap_sift_down(&heap, 0);
+            } else {
+                heap.pages[heap.size] = page;
+                heap.position[page] = heap.size;
+                opt_heap_sift_up(&heap, heap.size++);
+            }
+        }
+    }
+
+    free(next_index);
+    free(last_seen);
+    free(heap.pages);
+    free(heap.next_use);
+    free(heap.position);
+    return faults;
+}
+
+
+/*
+ * HELPER FUNCTION
+ * Counts the faults of a list policy over a trace, starting with no page resident
+ * */
+static size_t list_policy_faults(const page_swap_policy_t kind, const uint16_t* pages, const size_t count,
+        const size_t frame_count) {
+    if (! pages) {
+        return SIZE_MAX;
+    }
+
+    list_policy_t policy;
+    if (! list_policy_create(&policy, kind, PAGE_NUMBER_SPACE, frame_count)) {
+        list_policy_destroy(&policy);
+        return SIZE_MAX;
+    }
+
+    size_t faults = 0;
+    size_t resident = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (list_policy_resident(&policy, pages[i])) {
+            list_policy_hit(&policy, pages[i]);
+            continue;
+        }
+
+        ++faults;
+        list_policy_miss(&policy, pages[i]);
+        if (resident == frame_count) {
+            list_policy_evict(&policy, list_policy_victim(&policy, NULL, NULL));
+        } else {
+            ++resident;
+        }
+        list_policy_insert(&policy, pages[i]);
+    }
+
+    list_policy_destroy(&policy);
+    return faults;
+}
+
+size_t adaptive_replacement_faults (const uint16_t* pages, const size_t count, const size_t frame_count) {
+    return list_policy_faults(PAGE_SWAP_ARC, pages, count, frame_count);
+}
+
+size_t two_queue_faults (const uint16_t* pages, const size_t count, const size_t frame_count) {
+    return list_policy_faults(PAGE_SWAP_2Q, pages, count, frame_count);
+}
+
+size_t lirs_faults (const uint16_t* pages, const size_t count, const size_t frame_count) {
+    return list_policy_faults(PAGE_SWAP_LIRS, pages, count, frame_count);
+}
+
+
+/*
+ * MISS RATIO CURVE
+ * Mattson's stack algorithm. LRU keeps a page resident in c frames exactly when
+ * fewer than c other distinct pages were referenced since its last use, so one
+ * histogram of these stack distances gives the LRU faults for every frame count.
+ * The distinct pages between two references are counted with a Fenwick tree
+ * over the times of the sampled references holding a one at the latest
+ * reference of every page
+ * */
+#define SAMPLE_SPACE 65536 // granularity of the spatial sampling threshold
+
+//spreads page numbers evenly over the sample space
+static uint32_t sample_hash(uint32_t page) {
+    page ^= page >> 16;
+    page *= 0x7feb352d;
+    page ^= page >> 15;
+    page *= 0x846ca68b;
+    page ^= page >> 16;
+    return page % SAMPLE_SPACE;
+}
+
+static void fenwick_add(size_t* tree, const size_t size, size_t slot, const int delta) {
+    for (++slot; slot <= size; slot += slot & (~slot + 1)) {
+        tree[slot - 1] += delta;
+    }
+}
+
+//sum of the first slot entries
+static size_t fenwick_sum(const size_t* tree, size_t slot) {
+    size_t sum = 0;
+    for (; slot > 0; slot -= slot & (~slot + 1)) {
+        sum += tree[slot - 1];
+    }
+    return sum;
+}
+
+/*
+ * HELPER FUNCTION
+ * Builds the miss counts using only the pages whose hash falls under threshold
+ * (SHARDS). Distances and counts of the sampled pages are scaled by the inverse
+ * sample rate, threshold == SAMPLE_SPACE is the exact curve
+ * */
+static bool stack_distance_misses(const uint16_t* pages, const size_t count, size_t* misses,
+        const size_t max_frames, const uint32_t threshold) {
+    if (! pages || ! misses || threshold == 0) {
+        return false;
+    }
+
+    //the tree only spans the sampled references, so it shrinks with the sample rate
+    size_t sample_count = count;
+    if (threshold < SAMPLE_SPACE) {
+        sample_count = 0;
+        for (size_t i = 0; i < count; ++i) {
+            sample_count += sample_hash(pages[i]) < threshold;
+        }
+    }
+
+    const double scale = (double)SAMPLE_SPACE / threshold;
+    size_t* tree = (size_t *) calloc(sample_count + 1, sizeof(size_t));
+    size_t* last_seen = (size_t *) malloc(PAGE_NUMBER_SPACE * sizeof(size_t));
+    // distances[d] counts references at stack distance d, the last slot collects cold
+    // misses and distances beyond max_frames
+    size_t* distances = (size_t *) calloc(max_frames + 2, sizeof(size_t));
+
+    if (! tree || ! last_seen || ! distances) {
+        free(tree);
+        free(last_seen);
+        free(distances);
+        return false;
+    }
+
+    for (size_t i = 0; i < PAGE_NUMBER_SPACE; ++i) {
+        last_seen[i] = NEVER_USED;
+    }
+
+    size_t sampled = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const uint16_t page = pages[i];
+        if (threshold < SAMPLE_SPACE && sample_hash(page) >= threshold) {
+            continue;
+        }
+
+        size_t slot = max_frames + 1;
+        if (last_seen[page] != NEVER_USED) {
+            //distinct pages since the last use, plus the page itself
+            const size_t distinct = fenwick_sum(tree, sampled) - fenwick_sum(tree, last_seen[page] + 1);
+            const size_t distance = (size_t)((distinct + 1) * scale + 0.5);
+            if (distance <= max_frames) {
+                slot = distance;
+            }
+            fenwick_add(tree, sample_count, last_seen[page], -1);
+        }
+
+        ++distances[slot];
+        fenwick_add(tree, sample_count, sampled, 1);
+        last_seen[page] = sampled++;
+    }
+
+    //a reference misses in c frames when its distance is greater than c
+    size_t beyond = distances[max_frames + 1];
+    for (size_t frames = max_frames + 1; frames-- > 0;) {
+        misses[frames] = (size_t)(beyond * scale + 0.5);
+        beyond += distances[frames];
+    }
+
+    free(tree);
+    free(last_seen);
+    free(distances);
+    return true;
+}
+
+bool lru_miss_counts (const uint16_t* pages, const size_t count, size_t* misses, const size_t max_frames) {
+    return stack_distance_misses(pages, count, misses, max_frames, SAMPLE_SPACE);
+}
+
+bool lru_miss_counts_sampled (const uint16_t* pages, const size_t count, size_t* misses,
+        const size_t max_frames, const double sample_rate) {
+    if (! (sample_rate > 0 && sample_rate <= 1)) {
+        return false;
+    }
+    uint32_t threshold = (uint32_t)(sample_rate * SAMPLE_SPACE + 0.5);
+    return stack_distance_misses(pages, count, misses, max_frames, threshold > 0 ? threshold : 1);
+}
+
+
+/*
+ * RADIX PAGE TABLE
+ * Six levels of 256 entries cover 48 bit virtual page numbers. Nodes are only
+ * allocated under mapped pages and freed again once they empty, so the memory
+ * follows the number of mapped pages rather than the size of the address space.
+ * Every node visited on a walk counts as one memory reference
+ * */
+#define RADIX_BITS 8
+#define RADIX_LEVELS 6
+#define RADIX_FANOUT (1 << RADIX_BITS)
+#define VPN_LIMIT ((uint64_t) 1 << (RADIX_BITS * RADIX_LEVELS))
+
+typedef struct {
+    size_t used; // children present
+    void* child[RADIX_FANOUT]; // interior nodes, leaves below the last interior level
+}radix_interior_t;
+
+typedef struct {
+    size_t used; // frames present
+    uint32_t frame[RADIX_FANOUT]; // NO_FRAME for pages not mapped
+}radix_leaf_t;
+
+struct page_swap_radix {
+    radix_interior_t root;
+    size_t interior_nodes; // besides the root
+    size_t leaves;
+    size_t entries;
+    size_t lookups;
+    size_t memory_references;
+};
+
+static size_t radix_index(const uint64_t vpn, const int level) {
+    return (vpn >> (level * RADIX_BITS)) & (RADIX_FANOUT - 1);
+}
+
+static void radix_free(radix_interior_t* const node, const int level) {
+    for (size_t i = 0; i < RADIX_FANOUT; ++i) {
+        if (node->child[i] && level > 1) {
+            radix_free((radix_interior_t *) node->child[i], level - 1);
+        }
+        free(node->child[i]);
+    }
+}
+
+page_swap_radix_t* page_swap_radix_create(void) {
+    return (page_swap_radix_t *) calloc(1, sizeof(page_swap_radix_t));
+}
+
+void page_swap_radix_destroy(page_swap_radix_t* const radix) {
+    if (radix) {
+        radix_free(&radix->root, RADIX_LEVELS - 1);
+        free(radix);
+    }
+}
+
+bool page_swap_radix_map(page_swap_radix_t* const radix, const uint64_t vpn, const uint32_t frame) {
+    if (! radix || vpn >= VPN_LIMIT || frame == NO_FRAME) {
+        return false;
+    }
+
+    radix_interior_t* node = &radix->root;
+    for (int level = RADIX_LEVELS - 1; level > 1; --level) {
+        void** slot = &node->child[radix_index(vpn, level)];
+        if (! *slot) {
+            if (! (*slot = calloc(1, sizeof(radix_interior_t)))) {
+                return false;
+            }
+            ++node->used;
+            ++radix->interior_nodes;
+        }
+        node = (radix_interior_t *) *slot;
+    }
+
+    void** slot = &node->child[radix_index(vpn, 1)];
+    if (! *slot) {
+        radix_leaf_t* leaf = (radix_leaf_t *) malloc(sizeof(radix_leaf_t));
+        if (! leaf) {
+            return false;
+        }
+        leaf->used = 0;
+        memset(leaf->frame, 0xff, sizeof(leaf->frame));
+        *slot = leaf;
+        ++node->used;
+        ++radix->leaves;
+    }
+    radix_leaf_t* leaf = (radix_leaf_t *) *slot;
+    uint32_t* entry = &leaf->frame[radix_index(vpn, 0)];
+    if (*entry == NO_FRAME) {
+        ++leaf->used;
+        ++radix->entries;
+    }
+    *entry = frame;
+    return true;
+}
+
+bool page_swap_radix_unmap(page_swap_radix_t* const radix, const uint64_t vpn) {
+    if (! radix || vpn >= VPN_LIMIT) {
+        return false;
+    }
+
+    //remember the walk so emptied nodes can be freed bottom up
+    radix_interior_t* path[RADIX_LEVELS];
+    path[RADIX_LEVELS - 1] = &radix->root;
+    for (int level = RADIX_LEVELS - 1; level > 1; --level) {
+        path[level - 1] = (radix_interior_t *) path[level]->child[radix_index(vpn, level)];
+        if (! path[level - 1]) {
+            return false;
+        }
+    }
+    radix_leaf_t* leaf = (radix_leaf_t *) path[1]->child[radix_index(vpn, 1)];
+    if (! leaf || leaf->frame[radix_index(vpn, 0)] == NO_FRAME) {
+        return false;
+    }
+    leaf->frame[radix_index(vpn, 0)] = NO_FRAME;
+    --radix->entries;
+
+    if (--leaf->used > 0) {
+        return true;
+    }
+    free(leaf);
+    path[1]->child[radix_index(vpn, 1)] = NULL;
+    --radix->leaves;
+    for (int level = 1; --path[level]->used == 0 && level < RADIX_LEVELS - 1; ++level) {
+        free(path[level]);
+        path[level + 1]->child[radix_index(vpn, level + 1)] = NULL;
+        --radix->interior_nodes;
+    }
+    return true;
+}
+
+uint32_t page_swap_radix_lookup(page_swap_radix_t* const radix, const uint64_t vpn) {
+    if (! radix || vpn >= VPN_LIMIT) {
+        return NO_FRAME;
+    }
+
+    ++radix->lookups;
+    const radix_interior_t* node = &radix->root;
+    for (int level = RADIX_LEVELS - 1; level > 1; --level) {
+        ++radix->memory_references;
+        node = (const radix_interior_t *) node->child[radix_index(vpn, level)];
+        if (! node) {
+            return NO_FRAME;
+        }
+    }
+    ++radix->memory_references;
+    const radix_leaf_t* leaf = (const radix_leaf_t *) node->child[radix_index(vpn, 1)];
+    if (! leaf) {
+        return NO_FRAME;
+    }
+    ++radix->memory_references;
+    return leaf->frame[radix_index(vpn, 0)];
+}
+
+bool page_swap_radix_stats(const page_swap_radix_t* const radix, page_swap_table_stats_t* const stats) {
+    if (! radix || ! stats) {
+        return false;
+    }
+    stats->entries = radix->entries;
+    stats->footprint_bytes = sizeof(page_swap_radix_t) + radix->interior_nodes * sizeof(radix_interior_t)
+        + radix->leaves * sizeof(radix_leaf_t);
+    stats->lookups = radix->lookups;
+    stats->references_per_lookup = radix->lookups ? (double) radix->memory_references / radix->lookups : 0;
+    return true;
+}
+
+
+/*
+ * HASHED INVERTED PAGE TABLE
+ * One entry per frame naming the process and virtual page it holds, so the
+ * size follows physical memory no matter how large the address spaces are.
+ * A lookup hashes the process and page into an anchor table and follows the
+ * chain of frames with the same hash, every entry read is a memory reference
+ * */
+struct page_swap_inverted {
+    size_t frame_count;
+    size_t bucket_mask; // anchor count - 1, the anchor count is a power of two
+    uint32_t* anchor; // first frame of every hash chain
+    uint32_t* next; // next frame in the chain of every frame
+    uint64_t* vpn; // page held by every frame, VPN_LIMIT when the frame is free
+    uint32_t* process;
+    size_t entries;
+    size_t lookups;
+    size_t memory_references;
+};
+
+static size_t inverted_bucket(const page_swap_inverted_t* const table, const size_t process, const uint64_t vpn) {
+    uint64_t hash = vpn ^ ((uint64_t) process << 48);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash & table->bucket_mask;
+}
+
+page_swap_inverted_t* page_swap_inverted_create(const size_t frame_count) {
+    if (frame_count == 0 || frame_count >= NO_FRAME) {
+        return NULL;
+    }
+
+    page_swap_inverted_t* table = (page_swap_inverted_t *) calloc(1, sizeof(page_swap_inverted_t));
+    if (! table) {
+        return NULL;
+    }
+    //about two anchors per frame keeps the chains short
+    size_t bucket_count = 1;
+    while (bucket_count < 2 * frame_count) {
+        bucket_count <<= 1;
+    }
+    table->frame_count = frame_count;
+    table->bucket_mask = bucket_count - 1;
+    table->anchor = (uint32_t *) malloc(bucket_count * sizeof(uint32_t));
+    table->next = (uint32_t *) malloc(frame_count * sizeof(uint32_t));
+    table->vpn = (uint64_t *) malloc(frame_count * sizeof(uint64_t));
+    table->process = (uint32_t *) malloc(frame_count * sizeof(uint32_t));
+    if (! table->anchor || ! table->next || ! table->vpn || ! table->process) {
+        page_swap_inverted_destroy(table);
+        return NULL;
+    }
+    memset(table->anchor, 0xff, bucket_count * sizeof(uint32_t));
+    for (size_t frame = 0; frame < frame_count; ++frame) {
+        table->vpn[frame] = VPN_LIMIT;
+    }
+    return table;
+}
+
+void page_swap_inverted_destroy(page_swap_inverted_t* const table) {
+    if (table) {
+        free(table->anchor);
+        free(table->next);
+        free(table->vpn);
+        free(table->process);
+        free(table);
+    }
+}
+
+// Finds the frame of a page without counting the walk, NO_FRAME if it is not mapped
+static uint32_t inverted_find(const page_swap_inverted_t* const table, const size_t process, const uint64_t vpn,
+        size_t* const references) {
+    uint32_t frame = table->anchor[inverted_bucket(table, process, vpn)];
+    ++*references;
+    while (frame != NO_FRAME) {
+        ++*references;
+        if (table->vpn[frame] == vpn && table->process[frame] == process) {
+            break;
+        }
+        frame = table->next[frame];
+    }
+    return frame;
+}
+
+// Clears a frame and takes it out of its hash chain
+static void inverted_clear(page_swap_inverted_t* const table, const uint32_t frame) {
+    uint32_t* link = &table->anchor[inverted_bucket(table, table->process[frame], table->vpn[frame])];
+    while (*link != frame) {
+        link = &table->next[*link];
+    }
+    *link = table->next[frame];
+    table->vpn[frame] = VPN_LIMIT;
+    --table->entries;
+}
+
+bool page_swap_inverted_map(page_swap_inverted_t* const table, const size_t process, const uint64_t vpn,
+        const uint32_t frame) {
+    if (! table || vpn >= VPN_LIMIT || frame >= table->frame_count || process >= ANY_PROCESS) {
+        return false;
+    }
+
+    //a frame holds one page and a page sits in one frame
+    size_t references = 0;
+    const uint32_t old_frame = inverted_find(table, process, vpn, &references);
+    if (old_frame != NO_FRAME) {
+        inverted_clear(table, old_frame);
+    }
+    if (table->vpn[frame] != VPN_LIMIT) {
+        inverted_clear(table, frame);
+    }
+
+    const size_t bucket = inverted_bucket(table, process, vpn);
+    table->vpn[frame] = vpn;
+    table->process[frame] = (uint32_t) process;
+    table->next[frame] = table->anchor[bucket];
+    table->anchor[bucket] = frame;
+    ++table->entries;
+    return true;
+}
+
+bool page_swap_inverted_unmap(page_swap_inverted_t* const table, const size_t process, const uint64_t vpn) {
+    if (! table || vpn >= VPN_LIMIT) {
+        return false;
+    }
+    size_t references = 0;
+    const uint32_t frame = inverted_find(table, process, vpn, &references);
+    if (frame == NO_FRAME) {
+        return false;
+    }
+    inverted_clear(table, frame);
+    return true;
+}
+
+uint32_t page_swap_inverted_lookup(page_swap_inverted_t* const table, const size_t process, const uint64_t vpn) {
+    if (! table || vpn >= VPN_LIMIT) {
+        return NO_FRAME;
+    }
+    ++table->lookups;
+    return inverted_find(table, process, vpn, &table->memory_references);
+}
+
+bool page_swap_inverted_stats(const page_swap_inverted_t* const table, page_swap_table_stats_t* const stats) {
+    if (! table || ! stats) {
+        return false;
+    }
+    stats->entries = table->entries;
+    stats->footprint_bytes = sizeof(page_swap_inverted_t) + (table->bucket_mask + 1) * sizeof(uint32_t)
+        + table->frame_count * (2 * sizeof(uint32_t) + sizeof(uint64_t));
+    stats->lookups = table->lookups;
+    stats->references_per_lookup = table->lookups ? (double) table->memory_references / table->lookups : 0;
+    return true;
+}
+
+
+/*
+ * TRACE FILES
+ * Page numbers are stored as the zigzag encoded difference to the previous page
+ * number, each a little endian base 128 varint. Every chunk starts over from page
+ * 0 so it decodes on its own. Layout, numbers little endian:
+ *   header: TRACE_MAGIC, references, chunks, index offset, 8 bytes each
+ *   the chunks back to back
+ *   index: the offset of every chunk and the end of the last one, 8 bytes each
+ * */
+#define TRACE_MAGIC "PSTRACE1"
+#define TRACE_HEADER_BYTES 32
+#define TRACE_VARINT_BYTES 3 // longest varint of a difference between two uint16_t
+#define TRACE_BINARY_BLOCK 4096 // page numbers read at once from a binary trace
+
+struct page_swap_trace {
+    unsigned char* map;
+    size_t map_size;
+    size_t references;
+    size_t chunks;
+    const unsigned char* index;
+};
+
+typedef struct {
+    const char* path;
+    FILE* file;
+    size_t references;
+    uint16_t previous;
+    uint64_t offset; // bytes written so far
+    uint64_t* chunk_offsets;
+    size_t chunk_capacity;
+    bool failed;
+}trace_writer_t;
+
+static void store_le64(unsigned char* const bytes, const uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = value >> (8 * i) & 0xff;
+    }
+}
+
+static uint64_t load_le64(const unsigned char* const bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= (uint64_t) bytes[i] << (8 * i);
+    }
+    return value;
+}
+
+static bool trace_writer_open(trace_writer_t* const writer, const char* const path) {
+    memset(writer, 0, sizeof(trace_writer_t));
+    writer->path = path;
+    writer->file = fopen(path, "wb");
+    if (! writer->file) {
+        return false;
+    }
+    //the header is written last, once the counts are known
+    unsigned char header[TRACE_HEADER_BYTES] = {0};
+    writer->failed = fwrite(header, 1, TRACE_HEADER_BYTES, writer->file) != TRACE_HEADER_BYTES;
+    writer->offset = TRACE_HEADER_BYTES;
+    return true;
+}
+
+static void trace_writer_add(trace_writer_t* const writer, const uint16_t page) {
+    const size_t chunk = writer->references / PAGE_SWAP_TRACE_CHUNK_REFERENCES;
+    if (writer->references % PAGE_SWAP_TRACE_CHUNK_REFERENCES == 0) {
+        if (chunk == writer->chunk_capacity) {
+            const size_t capacity = writer->chunk_capacity ? 2 * writer->chunk_capacity : 16;
+            uint64_t* offsets = (uint64_t *) realloc(writer->chunk_offsets, capacity * sizeof(uint64_t));
+            if (! offsets) {
+                writer->failed = true;
+                return;
+            }
+            writer->chunk_offsets = offsets;
+            writer->chunk_capacity = capacity;
+        }
+        writer->chunk_offsets[chunk] = writer->offset;
+        writer->previous = 0;
+    }
+
+    const int32_t difference = (int32_t) page - writer->previous;
+    uint32_t zigzag = ((uint32_t) difference << 1) ^ (uint32_t) (difference >> 31);
+    unsigned char bytes[TRACE_VARINT_BYTES];
+    size_t length = 0;
+    do {
+        bytes[length] = zigzag & 0x7f;
+        zigzag >>= 7;
+        bytes[length++] |= zigzag ? 0x80 : 0;
+    } while (zigzag);
+    writer->failed = writer->failed || fwrite(bytes, 1, length, writer->file) != length;
+    writer->offset += length;
+    writer->previous = page;
+    ++writer->references;
+}
+
+//writes the index and header and closes the file, which is removed on failure
+static bool trace_writer_close(trace_writer_t* const writer) {
+    const size_t chunks = (writer->references + PAGE_SWAP_TRACE_CHUNK_REFERENCES - 1) / PAGE_SWAP_TRACE_CHUNK_REFERENCES;
+    unsigned char bytes[8];
+    for (size_t chunk = 0; chunk <= chunks && ! writer->failed; ++chunk) {
+        store_le64(bytes, chunk < chunks ? writer->chunk_offsets[chunk] : writer->offset);
+        writer->failed = fwrite(bytes, 1, 8, writer->file) != 8;
+    }
+
+    unsigned char header[TRACE_HEADER_BYTES];
+    memcpy(header, TRACE_MAGIC, 8);
+    store_le64(header + 8, writer->references);
+    store_le64(header + 16, chunks);
+    store_le64(header + 24, writer->offset);
+    writer->failed = writer->failed || fseek(writer->file, 0, SEEK_SET) != 0
+        || fwrite(header, 1, TRACE_HEADER_BYTES, writer->file) != TRACE_HEADER_BYTES;
+    writer->failed = fclose(writer->file) != 0 || writer->failed;
+    free(writer->chunk_offsets);
+    if (writer->failed) {
+        remove(writer->path);
+    }
+    return ! writer->failed;
+}
+
+bool page_swap_trace_write(const char* const path, const uint16_t* pages, const size_t count) {
+    trace_writer_t writer;
+    if (! path || (! pages && count > 0) || ! trace_writer_open(&writer, path)) {
+        return false;
+    }
+    for (size_t i = 0; i < count && ! writer.failed; ++i) {
+        trace_writer_add(&writer, pages[i]);
+    }
+    return trace_writer_close(&writer);
+}
+
+bool page_swap_trace_convert(const char* const input, const bool binary, const char* const output) {
+    if (! input || ! output) {
+        return false;
+    }
+    FILE* in = fopen(input, binary ? "rb" : "r");
+    if (! in) {
+        return false;
+    }
+    trace_writer_t writer;
+    if (! trace_writer_open(&writer, output)) {
+        fclose(in);
+        return false;
+    }
+
+    if (binary) {
+        unsigned char block[2 * TRACE_BINARY_BLOCK];
+        size_t length;
+        while (! writer.failed && (length = fread(block, 1, sizeof(block), in)) > 0) {
+            //a page number split over two reads is a truncated file, reads only come up short at the end
+            if (length % 2) {
+                writer.failed = true;
+            }
+            for (size_t i = 0; i + 1 < length; i += 2) {
+                trace_writer_add(&writer, block[i] | block[i + 1] << 8);
+            }
+        }
+    } else {
+        unsigned long page;
+        int scanned;
+        while (! writer.failed && (scanned = fscanf(in, "%lu", &page)) == 1) {
+            if (page > UINT16_MAX) {
+                writer.failed = true;
+            } else {
+                trace_writer_add(&writer, page);
+            }
+        }
+        writer.failed = writer.failed || scanned != EOF;
+    }
+    writer.failed = writer.failed || ferror(in);
+    fclose(in);
+    return trace_writer_close(&writer);
+}
+
+page_swap_trace_t* page_swap_trace_open(const char* const path) {
+    if (! path) {
+        return NULL;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t) info.st_size < TRACE_HEADER_BYTES + 8) {
+        close(fd);
+        return NULL;
+    }
+    const size_t size = info.st_size;
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+    //replays read the chunks front to back
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    const unsigned char* bytes = (const unsigned char *) map;
+    const uint64_t references = load_le64(bytes + 8);
+    const uint64_t chunks = load_le64(bytes + 16);
+    const uint64_t index_offset = load_le64(bytes + 24);
+    //the index fills the rest of the file, which bounds chunks before it is multiplied
+    bool valid = memcmp(bytes, TRACE_MAGIC, 8) == 0
+        && index_offset >= TRACE_HEADER_BYTES && index_offset < size && (size - index_offset) % 8 == 0
+        && chunks == (size - index_offset) / 8 - 1
+        && references <= chunks * PAGE_SWAP_TRACE_CHUNK_REFERENCES
+        && (chunks == 0 || references > (chunks - 1) * PAGE_SWAP_TRACE_CHUNK_REFERENCES);
+    //chunk offsets run from the end of the header to the index
+    uint64_t previous = TRACE_HEADER_BYTES;
+    for (uint64_t chunk = 0; valid && chunk <= chunks; ++chunk) {
+        const uint64_t offset = load_le64(bytes + index_offset + 8 * chunk);
+        valid = offset >= previous && offset <= index_offset && (chunk > 0 || offset == TRACE_HEADER_BYTES)
+            && (chunk < chunks || offset == index_offset);
+        previous = offset;
+    }
+    page_swap_trace_t* trace = valid ? (page_swap_trace_t *) malloc(sizeof(page_swap_trace_t)) : NULL;
+    if (! trace) {
+        munmap(map, size);
+        return NULL;
+    }
+    trace->map = (unsigned char *) map;
+    trace->map_size = size;
+    trace->references = references;
+    trace->chunks = chunks;
+    trace->index = bytes + index_offset;
+    return trace;
+}
+
+void page_swap_trace_close(page_swap_trace_t* const trace) {
+    if (trace) {
+        munmap(trace->map, trace->map_size);
+        free(trace);
+    }
+}
+
+size_t page_swap_trace_length(const page_swap_trace_t* const trace) {
+    return trace ? trace->references : 0;
+}
+
+size_t page_swap_trace_chunk_count(const page_swap_trace_t* const trace) {
+    return trace ? trace->chunks : 0;
+}
+
+size_t page_swap_trace_chunk(const page_swap_trace_t* const trace, const size_t chunk, uint16_t* const pages) {
+    if (! trace || chunk >= trace->chunks || ! pages) {
+        return SIZE_MAX;
+    }
+    const size_t count = chunk + 1 < trace->chunks ? PAGE_SWAP_TRACE_CHUNK_REFERENCES
+        : trace->references - chunk * PAGE_SWAP_TRACE_CHUNK_REFERENCES;
+    const unsigned char* in = trace->map + load_le64(trace->index + 8 * chunk);
+    const unsigned char* const end = trace->map + load_le64(trace->index + 8 * (chunk + 1));
+
+    int32_t page = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t zigzag = 0;
+        for (int shift = 0; ; shift += 7) {
+            if (in == end || shift == 7 * TRACE_VARINT_BYTES) {
+                return SIZE_MAX;
+            }
+            zigzag |= (uint32_t) (*in & 0x7f) << shift;
+            if (! (*in++ & 0x80)) {
+                break;
+            }
+        }
+        page += (int32_t) (zigzag >> 1) ^ -(int32_t) (zigzag & 1);
+        if (page < 0 || page > UINT16_MAX) {
+            return SIZE_MAX;
+        }
+        pages[i] = page;
+    }
+    return in == end ? count : SIZE_MAX;
+}
+
+size_t page_swap_trace_replay(const page_swap_trace_t* const trace, page_swap_t* const context,
+        const page_swap_policy_t policy, const size_t process) {
+    if (! trace || ! context || ! context->bs || process >= context->process_count || policy == PAGE_SWAP_OPT) {
+        return SIZE_MAX;
+    }
+
+    //a list policy the context cannot set up would turn every reference into a hit
+    pthread_mutex_lock(&context->lock);
+    const bool runs = ! is_list_policy(policy) || list_policy_start(context, policy);
+    pthread_mutex_unlock(&context->lock);
+    uint16_t* pages = runs ? (uint16_t *) malloc(PAGE_SWAP_TRACE_CHUNK_REFERENCES * sizeof(uint16_t)) : NULL;
+    if (! pages) {
+        return SIZE_MAX;
+    }
+
+    size_t faults = 0;
+    size_t clock_time = 0;
+    for (size_t chunk = 0; chunk < trace->chunks && faults != SIZE_MAX; ++chunk) {
+        const size_t count = page_swap_trace_chunk(trace, chunk, pages);
+        for (size_t i = 0; i < count && count != SIZE_MAX; ++i) {
+            if (pages[i] >= context->page_count) {
+                faults = SIZE_MAX;
+                break;
+            }
+            page_request_result_t* result = page_swap_process_request(context, policy, process, pages[i],
+                clock_time++, false);
+            faults += result != NULL;
+            free(result);
+        }
+        if (count == SIZE_MAX) {
+            faults = SIZE_MAX;
+        }
+    }
+    free(pages);
+    return faults;
+}
+
+/*
+ * SWEEP DRIVER
+ * Workers take the next cell from a shared counter until none are left. A
+ * worker creates, runs and destroys one context per cell, reusing its back
+ * store file, and the mapped traces are only ever read. OPT looks ahead, so
+ * its cells run over the decoded traces instead
+ * */
+typedef struct {
+    page_swap_trace_t** traces;
+    size_t* page_counts; // largest page of every trace + 1
+    uint16_t** decoded; // every reference of every trace when OPT is swept, NULL otherwise
+    const size_t* frame_counts;
+    size_t frame_count_count;
+    const page_swap_policy_t* policies;
+    size_t policy_count;
+    page_swap_sweep_result_t* results;
+    size_t cells;
+    size_t next_cell;
+    const char* back_store_prefix;
+}sweep_t;
+
+typedef struct {
+    sweep_t* sweep;
+    size_t worker;
+}sweep_worker_t;
+
+static double seconds_since(const struct timespec* const start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void* sweep_main(void* arg) {
+    const sweep_worker_t* worker = (const sweep_worker_t *) arg;
+    sweep_t* sweep = worker->sweep;
+    char back_store_name[256];
+    snprintf(back_store_name, sizeof(back_store_name), "%s.%zu", sweep->back_store_prefix, worker->worker);
+
+    for (;;) {
+        const size_t cell = __atomic_fetch_add(&sweep->next_cell, 1, __ATOMIC_RELAXED);
+        if (cell >= sweep->cells) {
+            break;
+        }
+        const size_t trace = cell / (sweep->policy_count * sweep->frame_count_count);
+        page_swap_sweep_result_t* result = &sweep->results[cell];
+
+        //a context needs at least as many pages as frames
+        const size_t frame_count = result->frame_count;
+        const size_t page_count = sweep->page_counts[trace] > frame_count ? sweep->page_counts[trace] : frame_count;
+        page_swap_t* context = NULL;
+        struct timespec start;
+        if (result->policy == PAGE_SWAP_OPT) {
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            result->faults = optimal_page_faults(sweep->decoded[trace], result->references, frame_count);
+        } else {
+            context = page_swap_create_lazy(back_store_name, 1, page_count, frame_count);
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            result->faults = page_swap_trace_replay(sweep->traces[trace], context, result->policy, 0);
+        }
+        result->seconds = seconds_since(&start);
+        page_swap_destroy(context);
+        result->fault_rate = result->faults != SIZE_MAX && result->references
+            ? (double) result->faults / result->references : 0;
+    }
+    remove(back_store_name);
+    return NULL;
+}
+
+//largest page number in the trace + 1, 0 for an empty trace or SIZE_MAX for a corrupt one.
+//Every reference is copied to decoded unless it is NULL
+static size_t trace_page_count(const page_swap_trace_t* const trace, uint16_t* const pages, uint16_t* const decoded) {
+    size_t page_count = 0;
+    size_t decoded_count = 0;
+    for (size_t chunk = 0; chunk < trace->chunks; ++chunk) {
+        const size_t count = page_swap_trace_chunk(trace, chunk, pages);
+        if (count == SIZE_MAX || (decoded && count > trace->references - decoded_count)) {
+            return SIZE_MAX;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            page_count = pages[i] >= page_count ? pages[i] + 1 : page_count;
+        }
+        if (decoded) {
+            memcpy(decoded + decoded_count, pages, count * sizeof(uint16_t));
+            decoded_count += count;
+        }
+    }
+    return decoded && decoded_count != trace->references ? SIZE_MAX : page_count;
+}
+
+bool page_swap_sweep(const char* const* trace_paths, const size_t trace_count, const page_swap_policy_t* policies,
+        const size_t policy_count, const size_t* frame_counts, const size_t frame_count_count,
+        const char* const back_store_prefix, const size_t threads, page_swap_sweep_result_t* const results) {
+    if (! trace_paths || trace_count == 0 || ! policies || policy_count == 0 || ! frame_counts
+            || frame_count_count == 0 || ! back_store_prefix || ! results) {
+        return false;
+    }
+    bool sweeps_opt = false;
+    for (size_t i = 0; i < policy_count; ++i) {
+        if (! page_swap_policy_name(policies[i])) {
+            return false;
+        }
+        sweeps_opt = sweeps_opt || policies[i] == PAGE_SWAP_OPT;
+    }
+
+    sweep_t sweep;
+    memset(&sweep, 0, sizeof(sweep));
+    sweep.traces = (page_swap_trace_t **) calloc(trace_count, sizeof(page_swap_trace_t *));
+    sweep.page_counts = (size_t *) calloc(trace_count, sizeof(size_t));
+    sweep.decoded = sweeps_opt ? (uint16_t **) calloc(trace_count, sizeof(uint16_t *)) : NULL;
+    uint16_t* pages = (uint16_t *) malloc(PAGE_SWAP_TRACE_CHUNK_REFERENCES * sizeof(uint16_t));
+    bool opened = sweep.traces && sweep.page_counts && (! sweeps_opt || sweep.decoded) && pages;
+    for (size_t i = 0; i < trace_count && opened; ++i) {
+        sweep.traces[i] = page_swap_trace_open(trace_paths[i]);
+        if (sweep.traces[i] && sweep.decoded) {
+            sweep.decoded[i] = (uint16_t *) malloc((page_swap_trace_length(sweep.traces[i]) + 1) * sizeof(uint16_t));
+        }
+        opened = sweep.traces[i] && (! sweep.decoded || sweep.decoded[i])
+            && (sweep.page_counts[i] = trace_page_count(sweep.traces[i], pages, sweep.decoded ? sweep.decoded[i] : NULL))
+            != SIZE_MAX;
+    }
+    free(pages);
+
+    sweep.frame_counts = frame_counts;
+    sweep.frame_count_count = frame_count_count;
+    sweep.policies = policies;
+    sweep.policy_count = policy_count;
+    sweep.results = results;
+    sweep.cells = trace_count * policy_count * frame_count_count;
+    sweep.back_store_prefix = back_store_prefix;
+    for (size_t cell = 0; cell < sweep.cells && opened; ++cell) {
+        const size_t trace = cell / (policy_count * frame_count_count);
+        results[cell].trace = trace_paths[trace];
+        results[cell].policy = policies[cell / frame_count_count % policy_count];
+        results[cell].frame_count = frame_counts[cell % frame_count_count];
+        results[cell].references = page_swap_trace_length(sweep.traces[trace]);
+        results[cell].faults = SIZE_MAX;
+        results[cell].fault_rate = 0;
+        results[cell].seconds = 0;
+    }
+
+    size_t worker_count = threads;
+    if (worker_count == 0) {
+        const long online = sysconf(_SC_NPROCESSORS_ONLN);
+        worker_count = online > 0 ? online : 1;
+    }
+    worker_count = worker_count < sweep.cells ? worker_count : sweep.cells;
+    pthread_t* workers = opened ? (pthread_t *) malloc(worker_count * sizeof(pthread_t)) : NULL;
+    sweep_worker_t* arguments = opened ? (sweep_worker_t *) malloc(worker_count * sizeof(sweep_worker_t)) : NULL;
+    size_t started = 0;
+    if (workers && arguments) {
+        for (; started < worker_count; ++started) {
+            arguments[started].sweep = &sweep;
+            arguments[started].worker = started;
+            if (pthread_create(&workers[started], NULL, sweep_main, &arguments[started]) != 0) {
+                break;
+            }
+        }
+    }
+    //the workers that did start finish every cell between them
+    for (size_t i = 0; i < started; ++i) {
+        pthread_join(workers[i], NULL);
+    }
+    free(workers);
+    free(arguments);
+
+    for (size_t i = 0; sweep.traces && i < trace_count; ++i) {
+        page_swap_trace_close(sweep.traces[i]);
+    }
+    for (size_t i = 0; sweep.decoded && i < trace_count; ++i) {
+        free(sweep.decoded[i]);
+    }
+    free(sweep.decoded);
+    free(sweep.traces);
+    free(sweep.page_counts);
+    return started > 0;
+}
+
+const char* page_swap_policy_name(const page_swap_policy_t policy) {
+    switch (policy) {
+        case PAGE_SWAP_LFU:
+            return "LFU";
+        case PAGE_SWAP_ALRU:
+            return "ALRU";
+        case PAGE_SWAP_CLOCK:
+            return "CLOCK";
+        case PAGE_SWAP_WSCLOCK:
+            return "WSCLOCK";
+        case PAGE_SWAP_LFU_EXACT:
+            return "LFU_EXACT";
+        case PAGE_SWAP_MGLRU:
+            return "MGLRU";
+        case PAGE_SWAP_ARC:
+            return "ARC";
+        case PAGE_SWAP_2Q:
+            return "2Q";
+        case PAGE_SWAP_LIRS:
+            return "LIRS";
+        case PAGE_SWAP_OPT:
+            return "OPT";
+    }
+    return NULL;
+}
+
+//writes text as a JSON string
+static void json_string(FILE* const out, const char* text) {
+    fputc('"', out);
+    for (; *text; ++text) {
+        if (*text == '"' || *text == '\\') {
+            fputc('\\', out);
+            fputc(*text, out);
+        } else if ((unsigned char) *text < 0x20) {
+            fprintf(out, "\\u%04x", (unsigned char) *text);
+        } else {
+            fputc(*text, out);
+        }
+    }
+    fputc('"', out);
+}
+
+bool page_swap_sweep_write(FILE* const out, const page_swap_sweep_result_t* const results, const size_t count,
+        const bool json) {
+    if (! out || (! results && count > 0)) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (! results[i].trace || ! page_swap_policy_name(results[i].policy)) {
+            return false;
+        }
+    }
+
+    //a failed cell reports faults as -1
+    if (json) {
+        fputs("[", out);
+        for (size_t i = 0; i < count; ++i) {
+            const page_swap_sweep_result_t* result = &results[i];
+            fputs(i ? ",\n{\"trace\":" : "\n{\"trace\":", out);
+            json_string(out, result->trace);
+            fprintf(out, ",\"policy\":\"%s\",\"frames\":%zu,\"references\":%zu,\"faults\":%lld,"
+                "\"fault_rate\":%.6f,\"seconds\":%.6f}", page_swap_policy_name(result->policy), result->frame_count,
+                result->references, result->faults == SIZE_MAX ? -1 : (long long) result->faults,
+                result->fault_rate, result->seconds);
+        }
+        fputs("\n]\n", out);
+    } else {
+        fputs("trace,policy,frames,references,faults,fault_rate,seconds\n", out);
+        for (size_t i = 0; i < count; ++i) {
+            const page_swap_sweep_result_t* result = &results[i];
+            fprintf(out, "%s,%s,%zu,%zu,%lld,%.6f,%.6f\n", result->trace, page_swap_policy_name(result->policy),
+                result->frame_count, result->references,
+                result->faults == SIZE_MAX ? -1 : (long long) result->faults, result->fault_rate, result->seconds);
+        }
+    }
+    return ! ferror(out);
+}
+
+/*
+ * BACK STORE WRAPPER FUNCTIONS
+ * */
+bool page_swap_read (page_swap_t* const context, void *data, const unsigned int page) {
+	//the pool holds a newer copy than the back store
+	if (context && page < context->page_count && data && pool_load(context, 0, page, (unsigned char *) data, false)) {
+		return true;
+	}
+	return read_page(context, 0, data, page);
+}
+
+bool page_swap_write (page_swap_t* const context, const void *data, const unsigned int page) {
+	if (! write_page(context, 0, data, page)) {
+		return false;
+	}
+	//a stale compressed copy would win over the new data
+	if (context->pool && context->pool->slot_of[page] != NO_SLOT) {
+		pool_free_slot(context->pool, context->pool->slot_of[page]);
+	}
+	return true;
+}
+
+bool read_from_back_store (void *data, const unsigned int page) {
+	return page_swap_read(&ps, data, page);
+}
+
+bool write_to_back_store (const void *data, const unsigned int page) {
+	return page_swap_write(&ps, data, page);
 }
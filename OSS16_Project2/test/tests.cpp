@@ -2,6 +2,8 @@
 #include "gtest/gtest.h"
 #include <pthread.h>
 #include <cstring>
+#include <vector>
+#include <unistd.h>
 
 // Using a C library requires extern "C" to prevent function managling
 extern "C" {
@@ -108,6 +110,85 @@ TEST (ALRU, GoodInputMixPageFaults) {
 	score+=20;
 }
 
+TEST (ALRU, VictimHasSmallestTrackingByte) {
+	initialize();
+
+	// touch every resident page but page 5, then age the tracking bytes
+	for (uint16_t page_number = 0; page_number < 512; ++page_number) {
+		if (page_number != 5) {
+			ASSERT_EQ(NULL,approx_least_recently_used(page_number,1));
+		}
+	}
+	ASSERT_EQ(NULL,approx_least_recently_used(0,99));
+
+	page_request_result_t* prr = approx_least_recently_used(600,100);
+	ASSERT_NE((page_request_result_t*)NULL,prr);
+	ASSERT_EQ(5,prr->frame_replaced);
+	ASSERT_EQ(5,prr->page_replaced);
+	ASSERT_EQ(600,prr->page_requested);
+	free(prr);
+
+	destroy();
+}
+
+TEST (ALRU, CleanVictimNotWrittenBack) {
+	initialize();
+
+	// leave page 5 as the only frame with a low tracking byte
+	for (uint16_t page_number = 0; page_number < 512; ++page_number) {
+		if (page_number != 5) {
+			ASSERT_EQ(NULL,approx_least_recently_used(page_number,1));
+		}
+	}
+	ASSERT_EQ(NULL,approx_least_recently_used(0,99));
+
+	unsigned char marker[1024];
+	unsigned char read[1024];
+	memset(marker,7,1024);
+	ASSERT_EQ(true,back_store_write(ps.bs,5+8,marker));
+
+	page_request_result_t* prr = approx_least_recently_used(600,100);
+	ASSERT_NE((page_request_result_t*)NULL,prr);
+	ASSERT_EQ(5,prr->frame_replaced);
+	free(prr);
+
+	// page 5 was only read so its back store block was left alone
+	ASSERT_EQ(true,back_store_read(ps.bs,5+8,read));
+	ASSERT_EQ(0,memcmp(marker,read,1024));
+
+	destroy();
+}
+
+TEST (ALRU, DirtyVictimWrittenBack) {
+	initialize();
+
+	for (uint16_t page_number = 0; page_number < 512; ++page_number) {
+		if (page_number != 5) {
+			ASSERT_EQ(NULL,approx_least_recently_used(page_number,1));
+		}
+	}
+	ASSERT_EQ(NULL,approx_least_recently_used(0,99));
+	ASSERT_EQ(NULL,approx_least_recently_used_write(5,100));
+
+	unsigned char marker[1024];
+	unsigned char read[1024];
+	memset(marker,7,1024);
+	ASSERT_EQ(true,back_store_write(ps.bs,5+8,marker));
+
+	page_request_result_t* prr = approx_least_recently_used(600,101);
+	ASSERT_NE((page_request_result_t*)NULL,prr);
+	ASSERT_EQ(5,prr->frame_replaced);
+	free(prr);
+
+	// the frame contents replaced the marker on eviction
+	ASSERT_EQ(true,back_store_read(ps.bs,5+8,read));
+	for (int j = 0; j < 1024; ++j) {
+		ASSERT_EQ(j % 255,read[j]);
+	}
+
+	destroy();
+}
+
 //page_request_result_t* approx_least_recently_used (const uint16_t page_number)
 TEST (LFU, BadInput) {
 	initialize();
@@ -193,6 +274,282 @@ TEST (LFU, GoodInputMixPageFaults) {
 	score+=20;
 }
 
+TEST (LFU, VictimHasFewestTrackingBits) {
+	initialize();
+
+	// touch every resident page but page 5, then age the tracking bytes
+	for (uint16_t page_number = 0; page_number < 512; ++page_number) {
+		if (page_number != 5) {
+			ASSERT_EQ(NULL,least_frequently_used(page_number,1));
+		}
+	}
+	ASSERT_EQ(NULL,least_frequently_used(0,99));
+
+	page_request_result_t* prr = least_frequently_used(600,100);
+	ASSERT_NE((page_request_result_t*)NULL,prr);
+	ASSERT_EQ(5,prr->frame_replaced);
+	ASSERT_EQ(5,prr->page_replaced);
+	free(prr);
+
+	destroy();
+}
+
+TEST (CLOCK, BadInput) {
+	initialize();
+
+	ASSERT_EQ(NULL,clock_second_chance(2048,100));
+	ASSERT_EQ(NULL,working_set_clock(2049,100));
+
+	destroy();
+}
+
+TEST (CLOCK, GoodInputNoPageFaults) {
+	initialize();
+
+	size_t page_faults = 0;
+	for (size_t clock_time = 0; clock_time < 2048; ++clock_time) {
+		page_request_result_t* prr = clock_second_chance(rand() % 512,clock_time);
+		if (prr != NULL) {
+			page_faults++;
+			free(prr);
+		}
+	}
+	ASSERT_EQ(0,page_faults);
+
+	destroy();
+}
+
+TEST (CLOCK, SecondChanceSkipsReferencedFrames) {
+	initialize();
+
+	// every frame starts referenced, so the hand comes back around to frame 0
+	page_request_result_t* prr = clock_second_chance(600,1);
+	ASSERT_NE((page_request_result_t*)NULL,prr);
+	ASSERT_EQ(0,prr->frame_replaced);
+	free(prr);
+
+	// page 1 gets its bit back and is passed over
+	ASSERT_EQ(NULL,clock_second_chance(1,2));
+	prr = clock_second_chance(601,3);
+	ASSERT_NE((page_request_result_t*)NULL,prr);
+	ASSERT_EQ(2,prr->frame_replaced);
+	ASSERT_EQ(2,prr->page_replaced);
+	free(prr);
+
+	destroy();
+}
+
+TEST (WSCLOCK, EvictsOutsideWorkingSet) {
+	initialize();
+
+	// everything was just referenced, so the oldest frame goes
+	page_request_result_t* prr = working_set_clock(600,1);
+	ASSERT_NE((page_request_result_t*)NULL,prr);
+	ASSERT_EQ(0,prr->frame_replaced);
+	free(prr);
+
+	// page 2 stays in the working set, frame 1 has aged out of it
+	ASSERT_EQ(NULL,working_set_clock(2,999));
+	prr = working_set_clock(601,1000);
+	ASSERT_NE((page_request_result_t*)NULL,prr);
+	ASSERT_EQ(1,prr->frame_replaced);
+	free(prr);
+	prr = working_set_clock(602,1001);
+	ASSERT_NE((page_request_result_t*)NULL,prr);
+	ASSERT_EQ(3,prr->frame_replaced);
+	free(prr);
+
+	destroy();
+}
+
+TEST (OPT, BadInput) {
+	uint16_t pages[] = {1, 2, 3};
+
+	ASSERT_EQ(SIZE_MAX,optimal_page_faults(NULL,3,3));
+	ASSERT_EQ(SIZE_MAX,optimal_page_faults(pages,3,0));
+	ASSERT_EQ(0,optimal_page_faults(pages,0,3));
+}
+
+TEST (OPT, TextbookTrace) {
+	uint16_t pages[] = {7, 0, 1, 2, 0, 3, 0, 4, 2, 3, 0, 3, 2, 1, 2, 0, 1, 7, 0, 1};
+	size_t count = sizeof(pages) / sizeof(pages[0]);
+
+	ASSERT_EQ(9,optimal_page_faults(pages,count,3));
+	ASSERT_EQ(8,optimal_page_faults(pages,count,4));
+	// only compulsory faults once every page fits
+	ASSERT_EQ(6,optimal_page_faults(pages,count,6));
+}
+
+TEST (ADAPTIVE, BadInput) {
+	uint16_t pages[] = {1, 2, 3};
+
+	ASSERT_EQ(SIZE_MAX,adaptive_replacement_faults(NULL,3,3));
+	ASSERT_EQ(SIZE_MAX,adaptive_replacement_faults(pages,3,0));
+	ASSERT_EQ(SIZE_MAX,two_queue_faults(NULL,3,3));
+	ASSERT_EQ(SIZE_MAX,two_queue_faults(pages,3,0));
+	ASSERT_EQ(SIZE_MAX,lirs_faults(NULL,3,3));
+	ASSERT_EQ(SIZE_MAX,lirs_faults(pages,3,1));
+}
+
+TEST (ADAPTIVE, ScanDoesNotFlushHotSet) {
+	// ten hot pages referenced between runs of a long sequential scan
+	std::vector<uint16_t> pages;
+	uint16_t scan_page = 1000;
+	for (int round = 0; round < 100; ++round) {
+		for (uint16_t hot = 0; hot < 10; ++hot) {
+			pages.push_back(hot);
+			pages.push_back(hot);
+		}
+		for (int i = 0; i < 30; ++i) {
+			pages.push_back(scan_page++);
+		}
+	}
+	const size_t scan_faults = scan_page - 1000;
+	const size_t optimal = optimal_page_faults(&pages[0],pages.size(),20);
+
+	size_t faults = adaptive_replacement_faults(&pages[0],pages.size(),20);
+	ASSERT_LE(optimal,faults);
+	ASSERT_GE(scan_faults + 50,faults);
+
+	faults = lirs_faults(&pages[0],pages.size(),20);
+	ASSERT_LE(optimal,faults);
+	ASSERT_GE(scan_faults + 50,faults);
+}
+
+TEST (ADAPTIVE, TwoQueuePromotesRereferencedPage) {
+	// page 1 comes back while remembered in A1out, so the scan after it cannot evict it
+	uint16_t pages[] = {1, 2, 3, 4, 5, 1, 6, 7, 8, 9, 10, 1};
+	size_t count = sizeof(pages) / sizeof(pages[0]);
+
+	ASSERT_EQ(11,two_queue_faults(pages,count,4));
+}
+
+TEST (ADAPTIVE, TwoQueuePromotionKeepsOtherGhosts) {
+	// promoting page 3 out of A1out must not trim page 2, which is promoted next and outlives the scan
+	uint16_t pages[] = {1, 2, 3, 4, 5, 6, 7, 3, 2, 8, 9, 10, 2};
+	size_t count = sizeof(pages) / sizeof(pages[0]);
+
+	ASSERT_EQ(12,two_queue_faults(pages,count,4));
+}
+
+TEST (ADAPTIVE, RandomTraceNotBelowOptimal) {
+	std::vector<uint16_t> pages;
+	for (int i = 0; i < 20000; ++i) {
+		pages.push_back(rand() % 300);
+	}
+
+	for (size_t frames = 2; frames <= 256; frames *= 2) {
+		const size_t optimal = optimal_page_faults(&pages[0],pages.size(),frames);
+		ASSERT_LE(optimal,adaptive_replacement_faults(&pages[0],pages.size(),frames));
+		ASSERT_LE(optimal,two_queue_faults(&pages[0],pages.size(),frames));
+		ASSERT_LE(optimal,lirs_faults(&pages[0],pages.size(),frames));
+	}
+}
+
+TEST (ADAPTIVE, ContextRunsTraceCounterSteps) {
+	const page_swap_policy_t policies[] = {PAGE_SWAP_ARC, PAGE_SWAP_2Q, PAGE_SWAP_LIRS};
+	size_t (*const counters[])(const uint16_t*, const size_t, const size_t) = {adaptive_replacement_faults,
+		two_queue_faults, lirs_faults};
+
+	// a context starts out as if its frames had been referenced once in frame order
+	std::vector<uint16_t> pages;
+	for (uint16_t page_number = 0; page_number < 16; ++page_number) {
+		pages.push_back(page_number);
+	}
+	for (int i = 0; i < 5000; ++i) {
+		pages.push_back(rand() % 4 ? rand() % 40 : rand() % 256);
+	}
+
+	for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); ++i) {
+		page_swap_t* context = page_swap_create("PAGE_SWAP_LISTS",256,16);
+		ASSERT_NE((page_swap_t*)NULL,context);
+		size_t faults = 0;
+		for (size_t clock_time = 16; clock_time < pages.size(); ++clock_time) {
+			page_request_result_t* prr = page_swap_request(context,policies[i],pages[clock_time],clock_time,false);
+			faults += prr != NULL;
+			free(prr);
+		}
+		ASSERT_EQ(counters[i](&pages[0],pages.size(),16) - 16,faults);
+		page_swap_destroy(context);
+	}
+}
+
+TEST (ADAPTIVE, ContextScanDoesNotFlushHotSet) {
+	const page_swap_policy_t policies[] = {PAGE_SWAP_ARC, PAGE_SWAP_LIRS, PAGE_SWAP_CLOCK};
+
+	// the ten hot pages start out resident, CLOCK loses them to every scan. 2Q only
+	// keeps pages that come back while A1out remembers them, which the scans are too long for
+	for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); ++i) {
+		page_swap_t* context = page_swap_create("PAGE_SWAP_LISTS",4096,20);
+		ASSERT_NE((page_swap_t*)NULL,context);
+		size_t clock_time = 0;
+		size_t hot_faults = 0;
+		uint16_t scan_page = 1000;
+		for (int round = 0; round < 100; ++round) {
+			for (uint16_t hot = 0; hot < 20; ++hot) {
+				page_request_result_t* prr = page_swap_request(context,policies[i],hot / 2,clock_time++,false);
+				hot_faults += prr != NULL;
+				free(prr);
+			}
+			for (int scan = 0; scan < 30; ++scan) {
+				free(page_swap_request(context,policies[i],scan_page++,clock_time++,false));
+			}
+		}
+		if (policies[i] == PAGE_SWAP_CLOCK) {
+			ASSERT_LT(500,hot_faults);
+		} else {
+			ASSERT_GT(50,hot_faults);
+		}
+		page_swap_destroy(context);
+	}
+}
+
+TEST (MRC, BadInput) {
+	uint16_t pages[] = {1, 2, 3};
+	size_t misses[4];
+
+	ASSERT_EQ(false,lru_miss_counts(NULL,3,misses,3));
+	ASSERT_EQ(false,lru_miss_counts(pages,3,NULL,3));
+	ASSERT_EQ(false,lru_miss_counts_sampled(pages,3,misses,3,0));
+	ASSERT_EQ(false,lru_miss_counts_sampled(pages,3,misses,3,1.5));
+}
+
+TEST (MRC, TextbookTrace) {
+	uint16_t pages[] = {7, 0, 1, 2, 0, 3, 0, 4, 2, 3, 0, 3, 2, 1, 2, 0, 1, 7, 0, 1};
+	size_t count = sizeof(pages) / sizeof(pages[0]);
+	size_t misses[8];
+
+	ASSERT_EQ(true,lru_miss_counts(pages,count,misses,7));
+	ASSERT_EQ(20,misses[0]);
+	ASSERT_EQ(20,misses[1]);
+	ASSERT_EQ(12,misses[3]);
+	ASSERT_EQ(8,misses[4]);
+	ASSERT_EQ(6,misses[6]);
+	ASSERT_EQ(6,misses[7]);
+
+	// following every page is the exact curve
+	size_t sampled[8];
+	ASSERT_EQ(true,lru_miss_counts_sampled(pages,count,sampled,7,1.0));
+	ASSERT_EQ(0,memcmp(misses,sampled,sizeof(misses)));
+}
+
+TEST (MRC, SampledCloseToExact) {
+	std::vector<uint16_t> pages;
+	for (int i = 0; i < 200000; ++i) {
+		// skewed towards low page numbers
+		pages.push_back((rand() % 4096) * (rand() % 4096) / 4096);
+	}
+
+	std::vector<size_t> exact(1025);
+	std::vector<size_t> sampled(1025);
+	ASSERT_EQ(true,lru_miss_counts(&pages[0],pages.size(),&exact[0],1024));
+	ASSERT_EQ(true,lru_miss_counts_sampled(&pages[0],pages.size(),&sampled[0],1024,0.1));
+
+	for (size_t frames = 64; frames <= 1024; frames *= 2) {
+		ASSERT_NEAR((double)exact[frames],(double)sampled[frames],0.1 * pages.size());
+	}
+}
+
 TEST (write_to_back_store, BadInputs) {
 	initialize();
 	char *baddata = NULL;
@@ -263,6 +620,1583 @@ TEST (read_from_back_store, GoodInput) {
 	score += 8;
 }
 
+TEST (CONTEXT, BadInput) {
+	ASSERT_EQ(NULL,page_swap_create(NULL,2048,512));
+	ASSERT_EQ(NULL,page_swap_create("PAGE_SWAP_CTX",2048,0));
+	ASSERT_EQ(NULL,page_swap_create("PAGE_SWAP_CTX",512,513));
+	ASSERT_EQ(NULL,page_swap_create("PAGE_SWAP_CTX",65529,512));
+	ASSERT_EQ(NULL,page_swap_request(NULL,PAGE_SWAP_LFU,0,0,false));
+
+	page_swap_t* context = page_swap_create("PAGE_SWAP_CTX",256,16);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_ALRU,256,0,false));
+	char data[1024] = {0};
+	ASSERT_EQ(false,page_swap_read(context,data,256));
+	ASSERT_EQ(true,page_swap_read(context,data,255));
+	page_swap_destroy(context);
+}
+
+struct context_run {
+	const char* name;
+	page_swap_policy_t policy;
+	size_t frames;
+	size_t faults;
+};
+
+static void* run_context(void* arg) {
+	context_run* run = (context_run*)arg;
+	page_swap_t* context = page_swap_create(run->name,1024,run->frames);
+	run->faults = SIZE_MAX;
+	if (context) {
+		run->faults = 0;
+		for (size_t clock_time = 0; clock_time < 4096; ++clock_time) {
+			page_request_result_t* prr = page_swap_request(context,run->policy,(clock_time * 7) % 1024,clock_time,clock_time % 3 == 0);
+			if (prr != NULL) {
+				run->faults++;
+				free(prr);
+			}
+		}
+		page_swap_destroy(context);
+	}
+	return NULL;
+}
+
+TEST (CONTEXT, IndependentContextsOnThreads) {
+	context_run runs[] = {
+		{"PAGE_SWAP_T0",PAGE_SWAP_LFU,64,0},
+		{"PAGE_SWAP_T1",PAGE_SWAP_ALRU,128,0},
+		{"PAGE_SWAP_T2",PAGE_SWAP_CLOCK,256,0},
+		{"PAGE_SWAP_T3",PAGE_SWAP_WSCLOCK,512,0},
+	};
+	const size_t run_count = sizeof(runs) / sizeof(runs[0]);
+
+	// sequential reference results
+	size_t expected[run_count];
+	for (size_t i = 0; i < run_count; ++i) {
+		run_context(&runs[i]);
+		ASSERT_NE(SIZE_MAX,runs[i].faults);
+		expected[i] = runs[i].faults;
+	}
+
+	pthread_t threads[run_count];
+	for (size_t i = 0; i < run_count; ++i) {
+		ASSERT_EQ(0,pthread_create(&threads[i],NULL,run_context,&runs[i]));
+	}
+	for (size_t i = 0; i < run_count; ++i) {
+		pthread_join(threads[i],NULL);
+		ASSERT_EQ(expected[i],runs[i].faults);
+	}
+}
+
+TEST (PROCESSES, LocalReplacementKeepsQuota) {
+	page_swap_t* context = page_swap_create_processes("PAGE_SWAP_PROC",2,64,16);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(true,page_swap_set_scope(context,PAGE_SWAP_LOCAL));
+	ASSERT_EQ(false,page_swap_set_quota(context,2,8));
+	ASSERT_EQ(false,page_swap_set_quota(context,0,0));
+	ASSERT_EQ(NULL,page_swap_process_request(context,PAGE_SWAP_CLOCK,2,0,0,false));
+
+	// process 1 grows to its quota by taking frames from process 0
+	for (uint16_t page_number = 0; page_number < 8; ++page_number) {
+		page_request_result_t* prr = page_swap_process_request(context,PAGE_SWAP_CLOCK,1,page_number,page_number,false);
+		ASSERT_NE((page_request_result_t*)NULL,prr);
+		ASSERT_EQ(0,prr->process_replaced);
+		free(prr);
+	}
+
+	ASSERT_EQ(NULL,page_swap_process_request(context,PAGE_SWAP_CLOCK,1,3,8,false));
+
+	// then it replaces its own
+	page_request_result_t* prr = page_swap_process_request(context,PAGE_SWAP_CLOCK,1,40,8,false);
+	ASSERT_NE((page_request_result_t*)NULL,prr);
+	ASSERT_EQ(1,prr->process_replaced);
+	free(prr);
+
+	page_swap_process_stats_t stats;
+	ASSERT_EQ(false,page_swap_process_stats(context,2,&stats));
+	ASSERT_EQ(true,page_swap_process_stats(context,0,&stats));
+	ASSERT_EQ(8,stats.frames_held);
+	ASSERT_EQ(0,stats.references);
+	ASSERT_EQ(true,page_swap_process_stats(context,1,&stats));
+	ASSERT_EQ(8,stats.frames_held);
+	ASSERT_EQ(10,stats.references);
+	ASSERT_EQ(9,stats.faults);
+	ASSERT_DOUBLE_EQ(0.9,stats.fault_rate);
+
+	page_swap_destroy(context);
+}
+
+TEST (PROCESSES, ListPoliciesKeepQuota) {
+	const page_swap_policy_t policies[] = {PAGE_SWAP_ARC, PAGE_SWAP_2Q, PAGE_SWAP_LIRS};
+	for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); ++i) {
+		page_swap_t* context = page_swap_create_processes("PAGE_SWAP_PROC",2,64,16);
+		ASSERT_NE((page_swap_t*)NULL,context);
+		ASSERT_EQ(true,page_swap_set_scope(context,PAGE_SWAP_LOCAL));
+
+		// process 1 takes the frames of process 0 up to its quota, then only replaces its own
+		for (uint16_t page_number = 0; page_number < 40; ++page_number) {
+			page_request_result_t* prr = page_swap_process_request(context,policies[i],1,page_number,page_number,false);
+			ASSERT_NE((page_request_result_t*)NULL,prr);
+			ASSERT_EQ(page_number < 8 ? 0 : 1,prr->process_replaced);
+			free(prr);
+		}
+
+		page_swap_process_stats_t stats;
+		ASSERT_EQ(true,page_swap_process_stats(context,0,&stats));
+		ASSERT_EQ(8,stats.frames_held);
+		ASSERT_EQ(true,page_swap_process_stats(context,1,&stats));
+		ASSERT_EQ(8,stats.frames_held);
+		page_swap_destroy(context);
+	}
+}
+
+TEST (PROCESSES, GlobalReplacementLetsNeighbourTakeFrames) {
+	page_swap_t* context = page_swap_create_processes("PAGE_SWAP_PROC",2,64,16);
+	ASSERT_NE((page_swap_t*)NULL,context);
+
+	// a scanning process 1 pushes the idle process 0 out of memory entirely
+	for (size_t clock_time = 0; clock_time < 64; ++clock_time) {
+		free(page_swap_process_request(context,PAGE_SWAP_ALRU,1,clock_time,clock_time,false));
+	}
+
+	page_swap_process_stats_t stats;
+	ASSERT_EQ(true,page_swap_process_stats(context,0,&stats));
+	ASSERT_EQ(0,stats.frames_held);
+	ASSERT_EQ(true,page_swap_process_stats(context,1,&stats));
+	ASSERT_EQ(16,stats.frames_held);
+	ASSERT_EQ(64,stats.faults);
+
+	page_swap_destroy(context);
+}
+
+static size_t scan_faults(const size_t readahead, page_swap_process_stats_t* stats) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_RA",1024,64);
+	if (! context || ! page_swap_set_readahead(context,readahead)) {
+		page_swap_destroy(context);
+		return SIZE_MAX;
+	}
+	for (size_t clock_time = 0; clock_time < 960; ++clock_time) {
+		free(page_swap_request(context,PAGE_SWAP_CLOCK,64 + clock_time,clock_time,false));
+	}
+	page_swap_process_stats(context,0,stats);
+	page_swap_destroy(context);
+	return stats->faults;
+}
+
+TEST (READAHEAD, SequentialScanFaultsLess) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_RA",1024,64);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(false,page_swap_set_readahead(NULL,8));
+	ASSERT_EQ(false,page_swap_set_readahead(context,33));
+	page_swap_destroy(context);
+
+	page_swap_process_stats_t stats;
+	ASSERT_EQ(960,scan_faults(0,&stats));
+	ASSERT_EQ(0,stats.prefetches);
+
+	size_t faults = scan_faults(16,&stats);
+	ASSERT_GT(960 / 10,faults);
+	ASSERT_EQ(960,faults + stats.prefetch_hits);
+	ASSERT_EQ(stats.prefetches,stats.prefetch_hits);
+}
+
+TEST (READAHEAD, RandomFaultsDoNotReadAhead) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_RA",1024,64);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(true,page_swap_set_readahead(context,16));
+
+	for (size_t clock_time = 0; clock_time < 500; ++clock_time) {
+		free(page_swap_request(context,PAGE_SWAP_ALRU,(clock_time * 379) % 1024,clock_time,false));
+	}
+
+	page_swap_process_stats_t stats;
+	ASSERT_EQ(true,page_swap_process_stats(context,0,&stats));
+	ASSERT_EQ(0,stats.prefetches);
+
+	page_swap_destroy(context);
+}
+
+// Scans with readahead on and checks every fault maps the requested page to the replaced frame
+static void scan_keeps_faulted_pages(page_swap_t* context, const page_swap_policy_t policy, const size_t process) {
+	for (size_t clock_time = 0; clock_time < 960; ++clock_time) {
+		const uint16_t page_number = 64 + clock_time;
+		page_request_result_t* result = page_swap_process_request(context,policy,process,page_number,clock_time,false);
+		if (result) {
+			const page_t* page = &context->page_tables[process].entries[page_number];
+			ASSERT_EQ(1,page->valid);
+			ASSERT_EQ(result->frame_replaced,page->frame_table_idx);
+			free(result);
+		}
+	}
+	ASSERT_EQ(0,context->frames_reserved);
+}
+
+TEST (READAHEAD, BatchKeepsFaultedPage) {
+	const page_swap_policy_t policies[] = {PAGE_SWAP_LFU, PAGE_SWAP_ALRU, PAGE_SWAP_CLOCK, PAGE_SWAP_WSCLOCK,
+		PAGE_SWAP_MGLRU, PAGE_SWAP_ARC, PAGE_SWAP_2Q, PAGE_SWAP_LIRS};
+	for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); ++i) {
+		page_swap_t* context = page_swap_create("PAGE_SWAP_RA",1024,64);
+		ASSERT_NE((page_swap_t*)NULL,context);
+		ASSERT_EQ(true,page_swap_set_readahead(context,32));
+		scan_keeps_faulted_pages(context,policies[i],0);
+		page_swap_process_stats_t stats;
+		ASSERT_EQ(true,page_swap_process_stats(context,0,&stats));
+		ASSERT_LT(0,stats.prefetches);
+		page_swap_destroy(context);
+	}
+
+	//a local quota smaller than the window runs out of frames the batch may take
+	page_swap_t* context = page_swap_create_processes("PAGE_SWAP_RA",2,1024,64);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(true,page_swap_set_scope(context,PAGE_SWAP_LOCAL));
+	ASSERT_EQ(true,page_swap_set_quota(context,0,60));
+	ASSERT_EQ(true,page_swap_set_quota(context,1,4));
+	ASSERT_EQ(true,page_swap_set_readahead(context,16));
+	scan_keeps_faulted_pages(context,PAGE_SWAP_CLOCK,1);
+	page_swap_destroy(context);
+}
+
+TEST (READAHEAD, FaultWithoutCandidatesFails) {
+	const page_swap_policy_t policies[] = {PAGE_SWAP_LFU, PAGE_SWAP_ALRU, PAGE_SWAP_CLOCK, PAGE_SWAP_WSCLOCK,
+		PAGE_SWAP_LFU_EXACT, PAGE_SWAP_MGLRU, PAGE_SWAP_ARC, PAGE_SWAP_2Q, PAGE_SWAP_LIRS};
+	page_swap_t* context = page_swap_create("PAGE_SWAP_RA",64,4);
+	ASSERT_NE((page_swap_t*)NULL,context);
+
+	// with every frame reserved no policy finds a victim, the fault fails and maps nothing
+	for (uint32_t frame = 0; frame < 4; ++frame) {
+		reserve_frame(context,frame,true);
+	}
+	for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); ++i) {
+		ASSERT_EQ(NULL,page_swap_request(context,policies[i],10,i,false));
+		ASSERT_EQ(0,context->page_tables[0].entries[10].valid);
+	}
+	for (uint32_t frame = 0; frame < 4; ++frame) {
+		reserve_frame(context,frame,false);
+	}
+	page_request_result_t* result = page_swap_request(context,PAGE_SWAP_CLOCK,10,10,false);
+	ASSERT_NE((page_request_result_t*)NULL,result);
+	free(result);
+	page_swap_destroy(context);
+}
+
+TEST (FLUSHER, CleansDirtyFramesAheadOfFaults) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_FLUSH",256,32);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(false,page_swap_start_flusher(context,0,16));
+	ASSERT_EQ(false,page_swap_start_flusher(context,16,8));
+	ASSERT_EQ(false,page_swap_start_flusher(context,8,33));
+
+	// dirty every resident page
+	for (uint16_t page_number = 0; page_number < 32; ++page_number) {
+		ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_CLOCK,page_number,page_number,true));
+	}
+
+	ASSERT_EQ(true,page_swap_start_flusher(context,8,16));
+	ASSERT_EQ(false,page_swap_start_flusher(context,8,16));
+	for (int wait = 0; wait < 1000 && page_swap_flusher_writebacks(context) < 16; ++wait) {
+		usleep(1000);
+	}
+	page_swap_stop_flusher(context);
+	ASSERT_EQ(16,page_swap_flusher_writebacks(context));
+
+	// the clock takes the frames the flusher cleaned first
+	for (uint16_t page_number = 100; page_number < 116; ++page_number) {
+		free(page_swap_request(context,PAGE_SWAP_CLOCK,page_number,page_number,false));
+	}
+	page_swap_process_stats_t stats;
+	ASSERT_EQ(true,page_swap_process_stats(context,0,&stats));
+	ASSERT_EQ(16,stats.faults);
+	ASSERT_EQ(0,stats.fault_writebacks);
+
+	// the rest are still dirty
+	free(page_swap_request(context,PAGE_SWAP_CLOCK,200,200,false));
+	ASSERT_EQ(true,page_swap_process_stats(context,0,&stats));
+	ASSERT_EQ(1,stats.fault_writebacks);
+
+	page_swap_destroy(context);
+}
+
+TEST (FLUSHER, FaultsGoOnDuringWriteBack) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_FLUSH",256,32);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(true,page_swap_start_flusher(context,8,24));
+
+	// write faults and hits race the flusher, the data goes in under the lock like a store would
+	for (size_t i = 0; i < 4000; ++i) {
+		const uint16_t page_number = (i * 37) % 256;
+		free(page_swap_request(context,PAGE_SWAP_CLOCK,page_number,i,true));
+		pthread_mutex_lock(&context->lock);
+		memset(frame_bytes(context,context->page_tables[0].entries[page_number].frame_table_idx),(int) (i & 0xff),1024);
+		pthread_mutex_unlock(&context->lock);
+	}
+	page_swap_stop_flusher(context);
+	ASSERT_LT(0,page_swap_flusher_writebacks(context));
+	ASSERT_EQ(NO_FRAME,context->flushing_frame);
+
+	// a frame is only clean when the back store holds its data
+	size_t dirty = 0;
+	unsigned char block[1024];
+	for (uint32_t frame = 0; frame < 32; ++frame) {
+		dirty += context->frame_table.dirty[frame];
+		if (! context->frame_table.dirty[frame]) {
+			ASSERT_EQ(true,read_page(context,0,block,context->frame_table.page_table_idx[frame]));
+			ASSERT_EQ(0,memcmp(block,frame_bytes(context,frame),1024));
+		}
+	}
+	ASSERT_EQ(dirty,context->dirty_frames);
+	page_swap_destroy(context);
+}
+
+struct shared_run {
+	page_swap_t* context;
+	page_swap_policy_t policy;
+	unsigned int seed;
+	size_t requests;
+};
+
+static void* run_shared(void* arg) {
+	shared_run* run = (shared_run*) arg;
+	for (size_t i = 0; i < run->requests; ++i) {
+		// mostly hits on a hot range with a cold tail that keeps faulting
+		uint16_t page_number = rand_r(&run->seed) % 8 ? rand_r(&run->seed) % 48 : rand_r(&run->seed) % 512;
+		free(page_swap_request(run->context,run->policy,page_number,i,i % 4 == 0));
+	}
+	return NULL;
+}
+
+TEST (CONCURRENT, SharedContextStaysConsistent) {
+	ASSERT_EQ(false,page_swap_set_concurrent(NULL,true));
+	const page_swap_policy_t policies[] = {PAGE_SWAP_LFU,PAGE_SWAP_ALRU,PAGE_SWAP_CLOCK,PAGE_SWAP_WSCLOCK};
+	for (size_t p = 0; p < 4; ++p) {
+		page_swap_t* context = page_swap_create("PAGE_SWAP_SHARED",512,64);
+		ASSERT_NE((page_swap_t*)NULL,context);
+		ASSERT_EQ(true,page_swap_set_concurrent(context,true));
+
+		shared_run runs[4];
+		pthread_t threads[4];
+		for (unsigned int i = 0; i < 4; ++i) {
+			runs[i].context = context;
+			runs[i].policy = policies[p];
+			runs[i].seed = i + 1;
+			runs[i].requests = 20000;
+			ASSERT_EQ(0,pthread_create(&threads[i],NULL,run_shared,&runs[i]));
+		}
+		for (int i = 0; i < 4; ++i) {
+			ASSERT_EQ(0,pthread_join(threads[i],NULL));
+		}
+
+		page_swap_process_stats_t stats;
+		ASSERT_EQ(true,page_swap_process_stats(context,0,&stats));
+		ASSERT_EQ(80000,stats.references);
+		ASSERT_EQ(64,stats.frames_held);
+
+		// every frame is mapped by exactly the page it holds
+		size_t valid = 0;
+		for (uint16_t page_number = 0; page_number < 512; ++page_number) {
+			const page_t* page = &context->page_tables[0].entries[page_number];
+			if (page->valid) {
+				++valid;
+				ASSERT_EQ(page_number,context->frame_table.page_table_idx[page->frame_table_idx]);
+			}
+		}
+		ASSERT_EQ(64,valid);
+
+		ASSERT_EQ(true,page_swap_set_concurrent(context,false));
+		page_swap_destroy(context);
+	}
+}
+
+TEST (ZEROCOPY, FaultsOnlyUpdateTables) {
+	ASSERT_EQ(false,page_swap_set_zero_copy(NULL,true));
+	page_swap_t* context = page_swap_create("PAGE_SWAP_ZERO_COPY",256,16);
+	ASSERT_NE((page_swap_t*)NULL,context);
+
+	// a dirty private copy reaches the back store when the mode turns on
+	unsigned char block[1024];
+	memset(context->frame_data + 3 * 1024, 7, 1024);
+	free(page_swap_request(context,PAGE_SWAP_CLOCK,3,1,true));
+	ASSERT_EQ(true,page_swap_set_zero_copy(context,true));
+	ASSERT_EQ(true,page_swap_set_zero_copy(context,true));
+	ASSERT_EQ(true,page_swap_read(context,block,3));
+	ASSERT_EQ(7,block[0]);
+
+	// frames are the blocks of their pages
+	const uint32_t frame = context->page_tables[0].entries[3].frame_table_idx;
+	ASSERT_EQ(0,memcmp(block,frame_bytes(context,frame),1024));
+	frame_bytes(context,frame)[1] = 9;
+	ASSERT_EQ(true,page_swap_read(context,block,3));
+	ASSERT_EQ(9,block[1]);
+
+	for (size_t i = 0; i < 512; ++i) {
+		free(page_swap_request(context,PAGE_SWAP_CLOCK,(i * 37) % 256,i + 2,i % 2 == 0));
+	}
+	page_swap_process_stats_t stats;
+	ASSERT_EQ(true,page_swap_process_stats(context,0,&stats));
+	ASSERT_LT(0,stats.faults);
+	ASSERT_EQ(0,stats.fault_writebacks);
+
+	// turning it off hands every frame a copy of its page again
+	ASSERT_EQ(true,page_swap_set_zero_copy(context,false));
+	for (uint32_t i = 0; i < 16; ++i) {
+		ASSERT_EQ(true,page_swap_read(context,block,context->frame_table.page_table_idx[i]));
+		ASSERT_EQ(0,memcmp(block,context->frame_data + i * 1024,1024));
+	}
+	page_swap_destroy(context);
+}
+
+TEST (ZSWAP, CodecRoundTrips) {
+	unsigned char page[1024], compressed[768], decompressed[1024];
+	unsigned int seed = 5;
+	// runs, a repeating pattern, then noise the codec cannot shrink
+	for (int i = 0; i < 1024; ++i) {
+		page[i] = i < 300 ? 0 : i < 700 ? i % 13 : rand_r(&seed);
+	}
+	size_t length = lz_compress(page,compressed,sizeof(compressed));
+	ASSERT_LT(0,length);
+	ASSERT_EQ(true,lz_decompress(compressed,length,decompressed));
+	ASSERT_EQ(0,memcmp(page,decompressed,1024));
+	ASSERT_EQ(false,lz_decompress(compressed,length - 1,decompressed));
+
+	for (int i = 0; i < 1024; ++i) {
+		page[i] = rand_r(&seed);
+	}
+	ASSERT_EQ(0,lz_compress(page,compressed,sizeof(compressed)));
+}
+
+TEST (ZSWAP, FaultsHitThePool) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_ZSWAP",256,16);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	page_swap_pool_stats_t pool_stats;
+	ASSERT_EQ(false,page_swap_set_compressed_pool(NULL,4096));
+	ASSERT_EQ(false,page_swap_set_compressed_pool(context,100));
+	ASSERT_EQ(false,page_swap_pool_stats(context,&pool_stats));
+	ASSERT_EQ(true,page_swap_set_compressed_pool(context,64 * 1024));
+	ASSERT_EQ(false,page_swap_set_zero_copy(context,true));
+
+	// dirty a page with data of its own and push it out
+	memset(context->frame_data + 5 * 1024, 42, 1024);
+	free(page_swap_request(context,PAGE_SWAP_CLOCK,5,1,true));
+	for (uint16_t page_number = 16; page_number < 64; ++page_number) {
+		free(page_swap_request(context,PAGE_SWAP_CLOCK,page_number,page_number,true));
+	}
+	ASSERT_EQ(0,context->page_tables[0].entries[5].valid);
+	unsigned char block[1024];
+	ASSERT_EQ(true,page_swap_read(context,block,5));
+	ASSERT_EQ(42,block[0]);
+
+	// every dirty victim went to the pool, none to the back store
+	page_swap_process_stats_t stats;
+	ASSERT_EQ(true,page_swap_process_stats(context,0,&stats));
+	ASSERT_EQ(0,stats.fault_writebacks);
+	ASSERT_EQ(true,page_swap_pool_stats(context,&pool_stats));
+	ASSERT_LT(0,pool_stats.stores);
+	ASSERT_EQ(0,pool_stats.loads);
+
+	// faulting it back in reads the pool and gets the data back
+	free(page_swap_request(context,PAGE_SWAP_CLOCK,5,100,false));
+	const uint32_t frame = context->page_tables[0].entries[5].frame_table_idx;
+	ASSERT_EQ(42,context->frame_data[frame * 1024 + 1023]);
+	ASSERT_EQ(1,context->frame_table.dirty[frame]);
+	ASSERT_EQ(true,page_swap_pool_stats(context,&pool_stats));
+	ASSERT_EQ(1,pool_stats.loads);
+
+	// turning the pool off leaves the back store up to date
+	ASSERT_EQ(true,page_swap_read(context,block,20));
+	ASSERT_EQ(true,page_swap_set_compressed_pool(context,0));
+	unsigned char back_store_block[1024];
+	ASSERT_EQ(true,page_swap_read(context,back_store_block,20));
+	ASSERT_EQ(0,memcmp(block,back_store_block,1024));
+	page_swap_destroy(context);
+}
+
+TEST (ZSWAP, OverflowWritesBackOldest) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_ZSWAP",256,16);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(true,page_swap_set_compressed_pool(context,4096));
+	for (size_t i = 0; i < 1024; ++i) {
+		free(page_swap_request(context,PAGE_SWAP_CLOCK,i % 256,i,true));
+	}
+	page_swap_pool_stats_t pool_stats;
+	ASSERT_EQ(true,page_swap_pool_stats(context,&pool_stats));
+	ASSERT_LT(0,pool_stats.writebacks);
+	ASSERT_EQ(pool_stats.stores,pool_stats.stored_pages + pool_stats.writebacks + pool_stats.loads);
+	ASSERT_GE(4096,pool_stats.compressed_bytes);
+	page_swap_destroy(context);
+}
+
+TEST (ZSWAP, EmptiedSlabsChangeClass) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_ZSWAP",256,16);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	// one slab, first handed to the class of pages that compress well
+	ASSERT_EQ(true,page_swap_set_compressed_pool(context,4096));
+	for (uint16_t page_number = 0; page_number < 4; ++page_number) {
+		free(page_swap_request(context,PAGE_SWAP_CLOCK,page_number,page_number,true));
+		memset(frame_bytes(context,context->page_tables[0].entries[page_number].frame_table_idx),0x11,1024);
+	}
+	for (uint16_t page_number = 16; page_number < 32; ++page_number) {
+		free(page_swap_request(context,PAGE_SWAP_CLOCK,page_number,page_number,false));
+	}
+	page_swap_pool_stats_t pool_stats;
+	ASSERT_EQ(true,page_swap_pool_stats(context,&pool_stats));
+	ASSERT_EQ(4,pool_stats.stored_pages);
+
+	// faulting them back empties the slab
+	for (uint16_t page_number = 0; page_number < 4; ++page_number) {
+		free(page_swap_request(context,PAGE_SWAP_CLOCK,page_number,32 + page_number,false));
+	}
+	ASSERT_EQ(true,page_swap_pool_stats(context,&pool_stats));
+	ASSERT_EQ(0,pool_stats.stored_pages);
+
+	// the same pages now compress poorly and still find room
+	for (uint16_t page_number = 0; page_number < 4; ++page_number) {
+		free(page_swap_request(context,PAGE_SWAP_CLOCK,page_number,36 + page_number,true));
+		unsigned char* data = frame_bytes(context,context->page_tables[0].entries[page_number].frame_table_idx);
+		memset(data,0,1024);
+		for (size_t i = 0; i < 300; ++i) {
+			data[i] = (unsigned char) rand();
+		}
+	}
+	for (uint16_t page_number = 32; page_number < 64; ++page_number) {
+		free(page_swap_request(context,PAGE_SWAP_CLOCK,page_number,40 + page_number,false));
+	}
+	ASSERT_EQ(true,page_swap_pool_stats(context,&pool_stats));
+	ASSERT_EQ(0,pool_stats.rejects);
+	ASSERT_EQ(0,pool_stats.writebacks);
+	ASSERT_EQ(4,pool_stats.stored_pages);
+	ASSERT_LT(4 * 128,pool_stats.compressed_bytes);
+	page_swap_destroy(context);
+}
+
+TEST (TLB, BadInput) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_TLB",64,16);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	page_swap_tlb_config_t config = {16,4,PAGE_SWAP_TLB_LRU,false,1,30};
+	page_swap_tlb_stats_t stats;
+	ASSERT_EQ(false,page_swap_set_tlb(NULL,&config));
+	ASSERT_EQ(false,page_swap_tlb_stats(context,&stats));
+	config.ways = 3;
+	ASSERT_EQ(false,page_swap_set_tlb(context,&config));
+	config.ways = 0;
+	ASSERT_EQ(false,page_swap_set_tlb(context,&config));
+	config.ways = 4;
+	ASSERT_EQ(true,page_swap_set_tlb(context,&config));
+	ASSERT_EQ(false,page_swap_tlb_stats(context,NULL));
+	ASSERT_EQ(true,page_swap_set_tlb(context,NULL));
+	ASSERT_EQ(false,page_swap_tlb_stats(context,&stats));
+	page_swap_destroy(context);
+}
+
+TEST (TLB, HotSetHitsAfterFirstTouch) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_TLB",256,64);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	page_swap_tlb_config_t config = {16,4,PAGE_SWAP_TLB_LRU,false,1,30};
+	ASSERT_EQ(true,page_swap_set_tlb(context,&config));
+	for (size_t i = 0; i < 800; ++i) {
+		ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_CLOCK,i % 8,i,false));
+	}
+	page_swap_tlb_stats_t stats;
+	ASSERT_EQ(true,page_swap_tlb_stats(context,&stats));
+	ASSERT_EQ(800,stats.lookups);
+	ASSERT_EQ(8,stats.misses);
+	ASSERT_EQ(792,stats.hits);
+	ASSERT_DOUBLE_EQ(0.99,stats.hit_rate);
+	ASSERT_DOUBLE_EQ(1 + 0.01 * 30,stats.translation_cycles);
+
+	// twice the reach of the TLB misses on every lookup under LRU,
+	// only the first touch of the hot pages still hits
+	for (size_t i = 0; i < 320; ++i) {
+		ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_CLOCK,i % 32,i,false));
+	}
+	ASSERT_EQ(true,page_swap_tlb_stats(context,&stats));
+	ASSERT_EQ(8 + 320 - 8,stats.misses);
+	page_swap_destroy(context);
+}
+
+TEST (TLB, FlushOnSwitchLosesEntries) {
+	size_t misses[2];
+	for (int flush = 0; flush < 2; ++flush) {
+		page_swap_t* context = page_swap_create_processes("PAGE_SWAP_TLB",2,64,32);
+		ASSERT_NE((page_swap_t*)NULL,context);
+		page_swap_tlb_config_t config = {32,32,PAGE_SWAP_TLB_RANDOM,flush == 1,1,30};
+		ASSERT_EQ(true,page_swap_set_tlb(context,&config));
+		for (size_t i = 0; i < 400; ++i) {
+			// pages 8 to 11 stay clear of the frames the faults of process 1 take
+			free(page_swap_process_request(context,PAGE_SWAP_CLOCK,i % 2,(i / 2) % 4 + 8,i,false));
+		}
+		page_swap_tlb_stats_t stats;
+		ASSERT_EQ(true,page_swap_tlb_stats(context,&stats));
+		ASSERT_EQ(flush ? 399 : 0,stats.flushes);
+		misses[flush] = stats.misses;
+		page_swap_destroy(context);
+	}
+	ASSERT_EQ(8,misses[0]);
+	ASSERT_EQ(400,misses[1]);
+}
+
+TEST (TLB, ReplacedPageIsShotDown) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_TLB",64,4);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	page_swap_tlb_config_t config = {8,8,PAGE_SWAP_TLB_LRU,false,1,30};
+	ASSERT_EQ(true,page_swap_set_tlb(context,&config));
+	ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_CLOCK,0,0,false));
+	for (uint16_t page_number = 4; page_number < 8; ++page_number) {
+		free(page_swap_request(context,PAGE_SWAP_CLOCK,page_number,page_number,false));
+	}
+	page_request_result_t* result = page_swap_request(context,PAGE_SWAP_CLOCK,0,10,false);
+	ASSERT_NE((page_request_result_t*)NULL,result);
+	free(result);
+	page_swap_tlb_stats_t stats;
+	ASSERT_EQ(true,page_swap_tlb_stats(context,&stats));
+	ASSERT_LE(1,stats.shootdowns);
+	page_swap_destroy(context);
+}
+
+TEST (PAGETABLE, RadixBadInput) {
+	page_swap_radix_t* radix = page_swap_radix_create();
+	ASSERT_NE((page_swap_radix_t*)NULL,radix);
+	page_swap_table_stats_t stats;
+	ASSERT_EQ(false,page_swap_radix_map(NULL,1,1));
+	ASSERT_EQ(false,page_swap_radix_map(radix,(uint64_t)1 << 48,1));
+	ASSERT_EQ(false,page_swap_radix_map(radix,1,UINT32_MAX));
+	ASSERT_EQ(false,page_swap_radix_unmap(radix,1));
+	ASSERT_EQ(UINT32_MAX,page_swap_radix_lookup(radix,(uint64_t)1 << 48));
+	ASSERT_EQ(false,page_swap_radix_stats(radix,NULL));
+	ASSERT_EQ(false,page_swap_radix_stats(NULL,&stats));
+	page_swap_radix_destroy(radix);
+}
+
+TEST (PAGETABLE, RadixSparseAddressSpace) {
+	page_swap_radix_t* radix = page_swap_radix_create();
+	ASSERT_NE((page_swap_radix_t*)NULL,radix);
+	page_swap_table_stats_t empty, stats;
+	ASSERT_EQ(true,page_swap_radix_stats(radix,&empty));
+
+	// 1024 pages scattered over the whole 48 bit space
+	std::vector<uint64_t> vpns;
+	uint64_t vpn = 12345;
+	for (uint32_t frame = 0; frame < 1024; ++frame) {
+		vpn = (vpn * 6364136223846793005ULL + 1442695040888963407ULL);
+		vpns.push_back(vpn >> 16);
+		ASSERT_EQ(true,page_swap_radix_map(radix,vpns.back(),frame));
+	}
+	for (uint32_t frame = 0; frame < 1024; ++frame) {
+		ASSERT_EQ(frame,page_swap_radix_lookup(radix,vpns[frame]));
+	}
+	ASSERT_EQ(UINT32_MAX,page_swap_radix_lookup(radix,vpns[0] ^ 1));
+	ASSERT_EQ(true,page_swap_radix_stats(radix,&stats));
+	ASSERT_EQ(1024,stats.entries);
+	// one leaf per page at worst, nowhere near a flat table of 2^48 entries
+	ASSERT_GE(1024 * (sizeof(radix_leaf_t) + 4 * sizeof(radix_interior_t)),stats.footprint_bytes - empty.footprint_bytes);
+	// every walk to a leaf reads one node per level
+	ASSERT_DOUBLE_EQ(6,stats.references_per_lookup);
+
+	// emptied nodes are given back
+	for (uint32_t frame = 0; frame < 1024; ++frame) {
+		ASSERT_EQ(true,page_swap_radix_unmap(radix,vpns[frame]));
+	}
+	ASSERT_EQ(true,page_swap_radix_stats(radix,&stats));
+	ASSERT_EQ(0,stats.entries);
+	ASSERT_EQ(empty.footprint_bytes,stats.footprint_bytes);
+	page_swap_radix_destroy(radix);
+}
+
+TEST (PAGETABLE, InvertedOneEntryPerFrame) {
+	ASSERT_EQ((page_swap_inverted_t*)NULL,page_swap_inverted_create(0));
+	page_swap_inverted_t* table = page_swap_inverted_create(4096);
+	ASSERT_NE((page_swap_inverted_t*)NULL,table);
+	ASSERT_EQ(false,page_swap_inverted_map(table,0,1,4096));
+	ASSERT_EQ(false,page_swap_inverted_map(table,0,(uint64_t)1 << 48,0));
+	ASSERT_EQ(false,page_swap_inverted_unmap(table,0,1));
+	page_swap_table_stats_t empty, stats;
+	ASSERT_EQ(true,page_swap_inverted_stats(table,&empty));
+
+	// two processes with the same virtual pages in different frames
+	for (uint32_t frame = 0; frame < 4096; ++frame) {
+		ASSERT_EQ(true,page_swap_inverted_map(table,frame % 2,(uint64_t)(frame / 2) << 30,frame));
+	}
+	for (uint32_t frame = 0; frame < 4096; ++frame) {
+		ASSERT_EQ(frame,page_swap_inverted_lookup(table,frame % 2,(uint64_t)(frame / 2) << 30));
+	}
+	ASSERT_EQ(UINT32_MAX,page_swap_inverted_lookup(table,2,0));
+	ASSERT_EQ(true,page_swap_inverted_stats(table,&stats));
+	ASSERT_EQ(4096,stats.entries);
+	ASSERT_EQ(empty.footprint_bytes,stats.footprint_bytes);
+	ASSERT_GT(3,stats.references_per_lookup);
+
+	// reusing a frame drops the page it held, moving a page frees its old frame
+	ASSERT_EQ(true,page_swap_inverted_map(table,0,7,0));
+	ASSERT_EQ(UINT32_MAX,page_swap_inverted_lookup(table,0,0));
+	ASSERT_EQ(true,page_swap_inverted_map(table,0,7,2));
+	ASSERT_EQ(2,page_swap_inverted_lookup(table,0,7));
+	ASSERT_EQ(true,page_swap_inverted_stats(table,&stats));
+	ASSERT_EQ(4095,stats.entries);
+	ASSERT_EQ(true,page_swap_inverted_unmap(table,0,7));
+	ASSERT_EQ(UINT32_MAX,page_swap_inverted_lookup(table,0,7));
+	page_swap_inverted_destroy(table);
+}
+
+TEST (HUGEPAGE, BadInput) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_HUGE",512,64);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	page_swap_huge_stats_t stats;
+	ASSERT_EQ(false,page_swap_set_huge_pages(NULL,8,4));
+	ASSERT_EQ(false,page_swap_set_huge_pages(context,6,4));
+	ASSERT_EQ(false,page_swap_set_huge_pages(context,128,4));
+	ASSERT_EQ(false,page_swap_set_huge_pages(context,8,0));
+	ASSERT_EQ(false,page_swap_set_huge_pages(context,8,9));
+	ASSERT_EQ(false,page_swap_huge_stats(context,&stats));
+	ASSERT_EQ(true,page_swap_set_huge_pages(context,8,4));
+	ASSERT_EQ(false,page_swap_huge_stats(context,NULL));
+	page_swap_destroy(context);
+}
+
+TEST (HUGEPAGE, PromotionSavesFaults) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_HUGE",512,64);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(true,page_swap_set_huge_pages(context,8,4));
+
+	// the fourth resident page of region 200 to 207 promotes it
+	const uint16_t touched[] = {203,200,206,201};
+	for (size_t i = 0; i < 4; ++i) {
+		free(page_swap_request(context,PAGE_SWAP_CLOCK,touched[i],i,i == 0));
+	}
+	page_swap_huge_stats_t stats;
+	ASSERT_EQ(true,page_swap_huge_stats(context,&stats));
+	ASSERT_EQ(1,stats.promotions);
+	ASSERT_EQ(1,stats.huge_pages);
+	ASSERT_EQ(4,stats.fill_loads);
+	ASSERT_LT(0,stats.compaction_moves);
+
+	// the region sits in one aligned block and keeps its data and dirty byte
+	const uint32_t first_frame = context->page_tables[0].entries[200].frame_table_idx;
+	ASSERT_EQ(0,first_frame % 8);
+	for (uint16_t page_number = 200; page_number < 208; ++page_number) {
+		ASSERT_EQ(1,context->page_tables[0].entries[page_number].huge);
+		ASSERT_EQ(first_frame + page_number - 200,context->page_tables[0].entries[page_number].frame_table_idx);
+		ASSERT_EQ(page_number,context->frame_table.page_table_idx[first_frame + page_number - 200]);
+	}
+	ASSERT_EQ(1,context->frame_table.dirty[first_frame + 3]);
+
+	// the rest of the region no longer faults
+	for (uint16_t page_number = 200; page_number < 208; ++page_number) {
+		ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_CLOCK,page_number,10 + page_number,false));
+	}
+	page_swap_process_stats_t process_stats;
+	ASSERT_EQ(true,page_swap_process_stats(context,0,&process_stats));
+	ASSERT_EQ(4,process_stats.faults);
+	page_swap_destroy(context);
+}
+
+TEST (HUGEPAGE, PromotionKeepsLocalQuota) {
+	page_swap_t* context = page_swap_create_processes("PAGE_SWAP_HUGE",2,512,64);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(true,page_swap_set_huge_pages(context,8,4));
+	ASSERT_EQ(true,page_swap_set_scope(context,PAGE_SWAP_LOCAL));
+	ASSERT_EQ(true,page_swap_set_quota(context,0,58));
+	ASSERT_EQ(true,page_swap_set_quota(context,1,6));
+
+	// filling region 200 to 207 would take process 1 to 8 frames, over its quota of 6
+	const uint16_t touched[] = {203,200,206,201};
+	for (size_t i = 0; i < 4; ++i) {
+		free(page_swap_process_request(context,PAGE_SWAP_CLOCK,1,touched[i],i,false));
+	}
+	page_swap_huge_stats_t stats;
+	ASSERT_EQ(true,page_swap_huge_stats(context,&stats));
+	ASSERT_EQ(0,stats.promotions);
+	ASSERT_EQ(1,stats.quota_refusals);
+	ASSERT_EQ(4,context->processes[1].frames_held);
+	ASSERT_EQ(60,context->processes[0].frames_held);
+
+	// with room in the quota the next fault of the region promotes it
+	ASSERT_EQ(true,page_swap_set_quota(context,1,8));
+	free(page_swap_process_request(context,PAGE_SWAP_CLOCK,1,202,4,false));
+	ASSERT_EQ(true,page_swap_huge_stats(context,&stats));
+	ASSERT_EQ(1,stats.promotions);
+	ASSERT_EQ(8,context->processes[1].frames_held);
+	ASSERT_EQ(56,context->processes[0].frames_held);
+	page_swap_destroy(context);
+}
+
+TEST (HUGEPAGE, OneTlbEntryPerHugePage) {
+	size_t misses[2];
+	for (int huge = 0; huge < 2; ++huge) {
+		page_swap_t* context = page_swap_create("PAGE_SWAP_HUGE",512,64);
+		ASSERT_NE((page_swap_t*)NULL,context);
+		page_swap_tlb_config_t config = {8,8,PAGE_SWAP_TLB_LRU,false,1,30};
+		ASSERT_EQ(true,page_swap_set_tlb(context,&config));
+		if (huge) {
+			ASSERT_EQ(true,page_swap_set_huge_pages(context,8,1));
+		}
+		// 32 pages loop through an 8 entry TLB
+		for (size_t i = 0; i < 640; ++i) {
+			free(page_swap_request(context,PAGE_SWAP_CLOCK,128 + i % 32,i,false));
+		}
+		page_swap_tlb_stats_t stats;
+		ASSERT_EQ(true,page_swap_tlb_stats(context,&stats));
+		misses[huge] = stats.misses;
+		page_swap_destroy(context);
+	}
+	ASSERT_EQ(640,misses[0]);
+	ASSERT_GT(32,misses[1]);
+}
+
+TEST (HUGEPAGE, ReplacingAFrameSplitsTheHugePage) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_HUGE",512,16);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(true,page_swap_set_huge_pages(context,8,2));
+	free(page_swap_request(context,PAGE_SWAP_CLOCK,100,0,false));
+	free(page_swap_request(context,PAGE_SWAP_CLOCK,101,1,false));
+	page_swap_huge_stats_t stats;
+	ASSERT_EQ(true,page_swap_huge_stats(context,&stats));
+	ASSERT_EQ(1,stats.huge_pages);
+	ASSERT_EQ(0,stats.fragmented_blocks);
+
+	// scattered faults eat into the huge page and leave mixed blocks behind
+	for (uint16_t page_number = 300; page_number < 316; page_number += 8) {
+		free(page_swap_request(context,PAGE_SWAP_CLOCK,page_number,page_number,false));
+	}
+	for (uint16_t page_number = 400; page_number < 500; page_number += 8) {
+		free(page_swap_request(context,PAGE_SWAP_CLOCK,page_number,page_number,false));
+	}
+	ASSERT_EQ(true,page_swap_huge_stats(context,&stats));
+	ASSERT_EQ(1,stats.demotions);
+	ASSERT_EQ(0,stats.huge_pages);
+	ASSERT_LT(0,stats.fragmented_blocks);
+	for (uint16_t page_number = 96; page_number < 104; ++page_number) {
+		ASSERT_EQ(0,context->page_tables[0].entries[page_number].huge);
+	}
+
+	// turning huge pages off splits what is left
+	free(page_swap_request(context,PAGE_SWAP_CLOCK,0,600,false));
+	free(page_swap_request(context,PAGE_SWAP_CLOCK,1,601,false));
+	ASSERT_EQ(true,page_swap_set_huge_pages(context,0,0));
+	for (uint16_t page_number = 0; page_number < 8; ++page_number) {
+		ASSERT_EQ(0,context->page_tables[0].entries[page_number].huge);
+	}
+	page_swap_destroy(context);
+}
+
+TEST (INIT, BulkFillMatchesPattern) {
+	page_swap_t* context = page_swap_create_processes("PAGE_SWAP_BULK",4,8192,512);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	unsigned char expected[1024], block[1024];
+	for (int j = 0; j < 1024; ++j) {
+		expected[j] = j % 255;
+	}
+	for (size_t process = 0; process < 4; ++process) {
+		for (unsigned int page_number = 0; page_number < 8192; page_number += 1021) {
+			ASSERT_EQ(true,read_page(context,process,block,page_number));
+			ASSERT_EQ(0,memcmp(expected,block,1024));
+		}
+		ASSERT_EQ(true,read_page(context,process,block,8191));
+		ASSERT_EQ(0,memcmp(expected,block,1024));
+	}
+	for (size_t frame = 0; frame < 512; ++frame) {
+		ASSERT_EQ(0,memcmp(expected,context->frame_data + frame * 1024,1024));
+	}
+	page_swap_destroy(context);
+}
+
+TEST (INIT, LazyPagesMaterializeOnWriteBack) {
+	ASSERT_EQ((page_swap_t*)NULL,page_swap_create_lazy(NULL,1,60000,512));
+	page_swap_t* context = page_swap_create_lazy("PAGE_SWAP_LAZY",1,60000,512);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(false,page_swap_set_zero_copy(context,true));
+
+	// untouched pages read as their initial data
+	unsigned char block[1024];
+	ASSERT_EQ(true,page_swap_read(context,block,59999));
+	for (int j = 0; j < 1024; ++j) {
+		ASSERT_EQ(j % 255,block[j]);
+	}
+
+	// a dirty page written back on replacement keeps what was written
+	memset(context->frame_data + 7 * 1024, 3, 1024);
+	free(page_swap_request(context,PAGE_SWAP_CLOCK,7,0,true));
+	for (uint16_t page_number = 1000; page_number < 2024; ++page_number) {
+		free(page_swap_request(context,PAGE_SWAP_CLOCK,page_number,page_number,false));
+	}
+	ASSERT_EQ(0,context->page_tables[0].entries[7].valid);
+	ASSERT_EQ(true,page_swap_read(context,block,7));
+	ASSERT_EQ(3,block[0]);
+	free(page_swap_request(context,PAGE_SWAP_CLOCK,7,3000,false));
+	ASSERT_EQ(3,context->frame_data[context->page_tables[0].entries[7].frame_table_idx * 1024]);
+
+	// a clean page comes back with its initial data without ever touching its block
+	ASSERT_EQ(true,page_swap_read(context,block,1500));
+	ASSERT_EQ(1,block[1]);
+	ASSERT_EQ(0,context->materialized[1500 / 64] >> (1500 % 64) & 1);
+	page_swap_destroy(context);
+}
+
+TEST (LFUEXACT, EvictsFewestReferences) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_LFU_EXACT",64,4);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(false,page_swap_set_lfu_decay(NULL,8));
+	ASSERT_EQ(0,get_num_bits(0));
+	ASSERT_EQ(8,get_num_bits(255));
+	ASSERT_EQ(3,get_num_bits(0x92));
+
+	// pages 0 to 3 are resident, referenced 4, 3, 1 and 2 more times
+	const uint16_t pattern[] = {0,0,0,0,1,1,1,2,3,3};
+	for (size_t i = 0; i < sizeof(pattern) / sizeof(pattern[0]); ++i) {
+		ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_LFU_EXACT,pattern[i],i,false));
+	}
+	page_request_result_t* result = page_swap_request(context,PAGE_SWAP_LFU_EXACT,10,20,false);
+	ASSERT_NE((page_request_result_t*)NULL,result);
+	ASSERT_EQ(2,result->page_replaced);
+	free(result);
+
+	// the new page has a single reference, so it goes next
+	result = page_swap_request(context,PAGE_SWAP_LFU_EXACT,11,21,false);
+	ASSERT_NE((page_request_result_t*)NULL,result);
+	ASSERT_EQ(10,result->page_replaced);
+	free(result);
+	// at equal counts the page that reached the count first goes
+	ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_LFU_EXACT,11,22,false));
+	ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_LFU_EXACT,11,23,false));
+	result = page_swap_request(context,PAGE_SWAP_LFU_EXACT,12,24,false);
+	ASSERT_NE((page_request_result_t*)NULL,result);
+	ASSERT_EQ(3,result->page_replaced);
+	free(result);
+	page_swap_destroy(context);
+}
+
+TEST (LFUEXACT, DecayLetsOldHotPagesGo) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_LFU_EXACT",64,2);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(true,page_swap_set_lfu_decay(context,16));
+
+	// page 0 was hot a long time ago, page 1 is referenced steadily since
+	for (size_t i = 0; i < 15; ++i) {
+		ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_LFU_EXACT,0,i,false));
+	}
+	for (size_t i = 0; i < 64; ++i) {
+		ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_LFU_EXACT,1,15 + i,false));
+	}
+	page_request_result_t* result = page_swap_request(context,PAGE_SWAP_LFU_EXACT,5,100,false);
+	ASSERT_NE((page_request_result_t*)NULL,result);
+	ASSERT_EQ(0,result->page_replaced);
+	free(result);
+
+	// without decay the old count keeps page 0
+	ASSERT_EQ(true,page_swap_set_lfu_decay(context,0));
+	for (size_t i = 0; i < 200; ++i) {
+		free(page_swap_request(context,PAGE_SWAP_LFU_EXACT,5,101 + i,false));
+	}
+	result = page_swap_request(context,PAGE_SWAP_LFU_EXACT,6,400,false);
+	ASSERT_NE((page_request_result_t*)NULL,result);
+	ASSERT_EQ(1,result->page_replaced);
+	free(result);
+	page_swap_destroy(context);
+}
+
+TEST (LFUEXACT, ReadaheadKeepsFaultedPage) {
+	// the faulted page starts out alone in the count 1 node, the batch must not take it
+	page_swap_t* context = page_swap_create("PAGE_SWAP_LFU_EXACT",1024,64);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(true,page_swap_set_readahead(context,16));
+	scan_keeps_faulted_pages(context,PAGE_SWAP_LFU_EXACT,0);
+
+	page_swap_process_stats_t stats;
+	ASSERT_EQ(true,page_swap_process_stats(context,0,&stats));
+	ASSERT_GT(960 / 10,stats.faults);
+	ASSERT_EQ(960,stats.faults + stats.prefetch_hits);
+	page_swap_destroy(context);
+}
+
+TEST (LFUEXACT, OtherPoliciesDoNotCount) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_LFU_EXACT",64,4);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	const frequency_list_t* list = &context->frequencies;
+	const uint32_t frame = context->page_tables[0].entries[0].frame_table_idx;
+	const size_t count = list->count[list->node_of[frame]];
+
+	// hits under the other policies leave the exact counts alone
+	for (size_t i = 0; i < 10; ++i) {
+		ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_CLOCK,0,i,false));
+		ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_ALRU,0,i,false));
+	}
+	ASSERT_EQ(count,list->count[list->node_of[frame]]);
+	ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_LFU_EXACT,0,10,false));
+	ASSERT_EQ(count + 1,list->count[list->node_of[frame]]);
+	page_swap_destroy(context);
+}
+
+TEST (MGLRU, EvictsFromTheOldestGeneration) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_MGLRU",64,4);
+	ASSERT_NE((page_swap_t*)NULL,context);
+
+	// pages 0 to 3 start in one generation, the hit on page 0 moves it to a younger one
+	ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_MGLRU,0,0,false));
+	page_request_result_t* result = page_swap_request(context,PAGE_SWAP_MGLRU,10,1,false);
+	ASSERT_NE((page_request_result_t*)NULL,result);
+	ASSERT_EQ(1,result->page_replaced);
+	free(result);
+
+	ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_MGLRU,2,2,false));
+	result = page_swap_request(context,PAGE_SWAP_MGLRU,11,3,false);
+	ASSERT_NE((page_request_result_t*)NULL,result);
+	ASSERT_EQ(3,result->page_replaced);
+	free(result);
+
+	// the oldest generation is empty now, the next one holds page 0 and page 10
+	result = page_swap_request(context,PAGE_SWAP_MGLRU,12,4,false);
+	ASSERT_NE((page_request_result_t*)NULL,result);
+	ASSERT_EQ(0,result->page_replaced);
+	free(result);
+	result = page_swap_request(context,PAGE_SWAP_MGLRU,13,5,false);
+	ASSERT_NE((page_request_result_t*)NULL,result);
+	ASSERT_EQ(10,result->page_replaced);
+	free(result);
+	page_swap_destroy(context);
+}
+
+TEST (MGLRU, OtherPoliciesDoNotBatch) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_MGLRU",64,4);
+	ASSERT_NE((page_swap_t*)NULL,context);
+
+	// hits under the other policies leave the generations alone
+	ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_CLOCK,0,0,false));
+	ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_LFU_EXACT,1,1,false));
+	ASSERT_EQ(0,context->generation_batch_size);
+	ASSERT_EQ(NULL,page_swap_request(context,PAGE_SWAP_MGLRU,0,2,false));
+	ASSERT_EQ(1,context->generation_batch_size);
+	page_swap_destroy(context);
+}
+
+TEST (MGLRU, FaultsCloseToExactLru) {
+	// a hot set of 48 pages with every fourth reference to a cold page
+	const size_t count = 20000;
+	uint16_t* pages = (uint16_t*) malloc(count * sizeof(uint16_t));
+	ASSERT_NE((uint16_t*)NULL,pages);
+	uint32_t seed = 7;
+	for (size_t i = 0; i < count; ++i) {
+		seed = seed * 1103515245 + 12345;
+		const uint32_t value = seed >> 8;
+		pages[i] = value % 4 == 0 ? 48 + value / 4 % 1000 : value / 4 % 48;
+	}
+	size_t misses[65];
+	ASSERT_EQ(true,lru_miss_counts(pages,count,misses,64));
+
+	page_swap_t* context = page_swap_create("PAGE_SWAP_MGLRU",1048,64);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	size_t faults = 0;
+	for (size_t i = 0; i < count; ++i) {
+		page_request_result_t* result = page_swap_request(context,PAGE_SWAP_MGLRU,pages[i],i,false);
+		faults += result != NULL;
+		free(result);
+	}
+	ASSERT_LE(faults,misses[64] + misses[64] / 10);
+	page_swap_destroy(context);
+	free(pages);
+}
+
+TEST (INSTRUMENT, BadInput) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_INSTRUMENT",64,8);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	page_swap_instrument_stats_t stats;
+	char json[16];
+	ASSERT_EQ(false,page_swap_set_instrumentation(NULL,true));
+	ASSERT_EQ(false,page_swap_instrument_stats(context,&stats));
+	ASSERT_EQ(SIZE_MAX,page_swap_instrument_json(context,json,sizeof(json)));
+	ASSERT_EQ(true,page_swap_set_instrumentation(context,true));
+	ASSERT_EQ(false,page_swap_instrument_stats(context,NULL));
+	ASSERT_EQ(SIZE_MAX,page_swap_instrument_json(context,NULL,sizeof(json)));
+
+	// every value lands in the bucket whose range holds it
+	const uint64_t values[] = {0,1,3,4,5,7,8,1000,1023,1024,123456789,UINT64_MAX};
+	for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+		const unsigned int bucket = latency_bucket(values[i]);
+		ASSERT_GT(LATENCY_BUCKETS,bucket);
+		ASSERT_LE(latency_bucket_floor(bucket),values[i]);
+		if (bucket + 1 < LATENCY_BUCKETS && latency_bucket_floor(bucket + 1) > 0) {
+			ASSERT_GT(latency_bucket_floor(bucket + 1),values[i]);
+		}
+	}
+	page_swap_destroy(context);
+}
+
+TEST (INSTRUMENT, CountsMatchTheSimulation) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_INSTRUMENT",256,32);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(true,page_swap_set_instrumentation(context,true));
+
+	unsigned int seed = 5;
+	for (size_t i = 0; i < 2000; ++i) {
+		free(page_swap_request(context,PAGE_SWAP_CLOCK,rand_r(&seed) % 64,i,i % 3 == 0));
+	}
+	page_swap_process_stats_t process;
+	ASSERT_EQ(true,page_swap_process_stats(context,0,&process));
+	page_swap_instrument_stats_t stats;
+	ASSERT_EQ(true,page_swap_instrument_stats(context,&stats));
+	ASSERT_EQ(2000,stats.hits + stats.faults);
+	ASSERT_EQ(process.faults,stats.faults);
+	ASSERT_EQ(stats.faults,stats.evictions);
+	ASSERT_EQ(stats.faults,stats.back_store_reads);
+	ASSERT_EQ(process.fault_writebacks,stats.back_store_writes);
+	ASSERT_EQ(stats.faults,stats.fault.count);
+	ASSERT_EQ(stats.faults,stats.victim_selection.count);
+	ASSERT_EQ(stats.faults,stats.io.count);
+	ASSERT_LE(stats.fault.p50_ns,stats.fault.p90_ns);
+	ASSERT_LE(stats.fault.p90_ns,stats.fault.p99_ns);
+	// a fault takes at least as long as its parts
+	ASSERT_GE(stats.fault.total_ns,stats.victim_selection.total_ns + stats.io.total_ns);
+
+	// turning it on again starts from zero
+	ASSERT_EQ(true,page_swap_set_instrumentation(context,true));
+	ASSERT_EQ(true,page_swap_instrument_stats(context,&stats));
+	ASSERT_EQ(0,stats.hits + stats.faults + stats.fault.count);
+	page_swap_destroy(context);
+}
+
+TEST (INSTRUMENT, JsonSnapshot) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_INSTRUMENT",64,8);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(true,page_swap_set_instrumentation(context,true));
+	for (size_t i = 0; i < 20; ++i) {
+		free(page_swap_request(context,PAGE_SWAP_ALRU,i,i,false));
+	}
+
+	const size_t length = page_swap_instrument_json(context,NULL,0);
+	ASSERT_NE(SIZE_MAX,length);
+	char* json = (char*) malloc(length + 1);
+	ASSERT_NE((char*)NULL,json);
+	ASSERT_EQ(length,page_swap_instrument_json(context,json,length + 1));
+	ASSERT_EQ(length,strlen(json));
+	ASSERT_NE((char*)NULL,strstr(json,"{\"hits\":8,\"faults\":12,\"evictions\":12,"));
+	ASSERT_NE((char*)NULL,strstr(json,"\"victim_selection\":{\"count\":12,"));
+	ASSERT_EQ('}',json[length - 1]);
+
+	// a short buffer gets a terminated prefix
+	char prefix[8];
+	ASSERT_EQ(length,page_swap_instrument_json(context,prefix,sizeof(prefix)));
+	ASSERT_EQ(0,strncmp(json,prefix,sizeof(prefix) - 1));
+	ASSERT_EQ('\0',prefix[sizeof(prefix) - 1]);
+	free(json);
+	page_swap_destroy(context);
+}
+
+TEST (INSTRUMENT, ConcurrentHitsAreCounted) {
+	page_swap_t* context = page_swap_create("PAGE_SWAP_INSTRUMENT",512,64);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(true,page_swap_set_concurrent(context,true));
+	ASSERT_EQ(true,page_swap_set_instrumentation(context,true));
+
+	shared_run runs[4];
+	pthread_t threads[4];
+	for (unsigned int i = 0; i < 4; ++i) {
+		runs[i].context = context;
+		runs[i].policy = PAGE_SWAP_CLOCK;
+		runs[i].seed = i + 1;
+		runs[i].requests = 10000;
+		ASSERT_EQ(0,pthread_create(&threads[i],NULL,run_shared,&runs[i]));
+	}
+	for (int i = 0; i < 4; ++i) {
+		ASSERT_EQ(0,pthread_join(threads[i],NULL));
+	}
+	page_swap_process_stats_t process;
+	ASSERT_EQ(true,page_swap_process_stats(context,0,&process));
+	page_swap_instrument_stats_t stats;
+	ASSERT_EQ(true,page_swap_instrument_stats(context,&stats));
+	ASSERT_EQ(40000,stats.hits + stats.faults);
+	ASSERT_EQ(process.faults,stats.faults);
+	page_swap_destroy(context);
+}
+
+TEST (TRACEFILE, RoundTripsAcrossChunks) {
+	ASSERT_EQ(false,page_swap_trace_write(NULL,NULL,0));
+	ASSERT_EQ(false,page_swap_trace_write("PAGE_SWAP_TRACE.pst",NULL,3));
+	ASSERT_EQ((page_swap_trace_t*)NULL,page_swap_trace_open("PAGE_SWAP_NO_SUCH_TRACE.pst"));
+	ASSERT_EQ(0,page_swap_trace_length(NULL));
+
+	// a local walk with a jump across the whole page range now and then
+	const size_t count = 2 * PAGE_SWAP_TRACE_CHUNK_REFERENCES + 1000;
+	std::vector<uint16_t> pages(count);
+	unsigned int seed = 3;
+	uint16_t page = 100;
+	for (size_t i = 0; i < count; ++i) {
+		page = i % 5000 == 0 ? (i % 10000 ? 65535 : 0) : page + rand_r(&seed) % 7 - 3;
+		pages[i] = page;
+	}
+	ASSERT_EQ(true,page_swap_trace_write("PAGE_SWAP_TRACE.pst",pages.data(),count));
+
+	page_swap_trace_t* trace = page_swap_trace_open("PAGE_SWAP_TRACE.pst");
+	ASSERT_NE((page_swap_trace_t*)NULL,trace);
+	ASSERT_EQ(count,page_swap_trace_length(trace));
+	ASSERT_EQ(3,page_swap_trace_chunk_count(trace));
+	// mostly one byte per reference
+	ASSERT_GT(count + count / 10,trace->map_size);
+
+	std::vector<uint16_t> chunk(PAGE_SWAP_TRACE_CHUNK_REFERENCES);
+	ASSERT_EQ(SIZE_MAX,page_swap_trace_chunk(trace,3,chunk.data()));
+	ASSERT_EQ(SIZE_MAX,page_swap_trace_chunk(trace,0,NULL));
+	size_t offset = 0;
+	for (size_t c = 0; c < 3; ++c) {
+		const size_t decoded = page_swap_trace_chunk(trace,c,chunk.data());
+		ASSERT_EQ(c < 2 ? PAGE_SWAP_TRACE_CHUNK_REFERENCES : 1000,decoded);
+		for (size_t i = 0; i < decoded; ++i) {
+			ASSERT_EQ(pages[offset + i],chunk[i]);
+		}
+		offset += decoded;
+	}
+	page_swap_trace_close(trace);
+
+	// an empty trace is a valid trace
+	ASSERT_EQ(true,page_swap_trace_write("PAGE_SWAP_TRACE.pst",NULL,0));
+	trace = page_swap_trace_open("PAGE_SWAP_TRACE.pst");
+	ASSERT_NE((page_swap_trace_t*)NULL,trace);
+	ASSERT_EQ(0,page_swap_trace_chunk_count(trace));
+	page_swap_trace_close(trace);
+	unlink("PAGE_SWAP_TRACE.pst");
+}
+
+static bool write_file(const char* path, const void* data, const size_t size) {
+	FILE* file = fopen(path,"wb");
+	if (! file) {
+		return false;
+	}
+	const bool written = fwrite(data,1,size,file) == size;
+	return fclose(file) == 0 && written;
+}
+
+TEST (TRACEFILE, ConvertsTextAndBinary) {
+	const uint16_t expected[] = {1,2,3,65535,0,7};
+	page_swap_trace_t* trace;
+	uint16_t pages[PAGE_SWAP_TRACE_CHUNK_REFERENCES];
+
+	const char text[] = "1 2 3\n65535\n0\n  7\n";
+	ASSERT_EQ(true,write_file("PAGE_SWAP_TRACE.txt",text,strlen(text)));
+	ASSERT_EQ(true,page_swap_trace_convert("PAGE_SWAP_TRACE.txt",false,"PAGE_SWAP_TRACE.pst"));
+	trace = page_swap_trace_open("PAGE_SWAP_TRACE.pst");
+	ASSERT_NE((page_swap_trace_t*)NULL,trace);
+	ASSERT_EQ(6,page_swap_trace_chunk(trace,0,pages));
+	ASSERT_EQ(0,memcmp(expected,pages,sizeof(expected)));
+	page_swap_trace_close(trace);
+
+	const unsigned char binary[] = {1,0,2,0,3,0,0xff,0xff,0,0,7,0};
+	ASSERT_EQ(true,write_file("PAGE_SWAP_TRACE.bin",binary,sizeof(binary)));
+	ASSERT_EQ(true,page_swap_trace_convert("PAGE_SWAP_TRACE.bin",true,"PAGE_SWAP_TRACE.pst"));
+	trace = page_swap_trace_open("PAGE_SWAP_TRACE.pst");
+	ASSERT_NE((page_swap_trace_t*)NULL,trace);
+	ASSERT_EQ(6,page_swap_trace_chunk(trace,0,pages));
+	ASSERT_EQ(0,memcmp(expected,pages,sizeof(expected)));
+	page_swap_trace_close(trace);
+
+	// malformed inputs leave no output behind
+	ASSERT_EQ(true,write_file("PAGE_SWAP_TRACE.bin",binary,sizeof(binary) - 1));
+	ASSERT_EQ(false,page_swap_trace_convert("PAGE_SWAP_TRACE.bin",true,"PAGE_SWAP_TRACE.pst"));
+	ASSERT_NE(0,access("PAGE_SWAP_TRACE.pst",F_OK));
+	ASSERT_EQ(true,write_file("PAGE_SWAP_TRACE.txt","1 x 2",5));
+	ASSERT_EQ(false,page_swap_trace_convert("PAGE_SWAP_TRACE.txt",false,"PAGE_SWAP_TRACE.pst"));
+	ASSERT_EQ(true,write_file("PAGE_SWAP_TRACE.txt","1 65536",7));
+	ASSERT_EQ(false,page_swap_trace_convert("PAGE_SWAP_TRACE.txt",false,"PAGE_SWAP_TRACE.pst"));
+	ASSERT_EQ(false,page_swap_trace_convert("PAGE_SWAP_NO_SUCH_TRACE.txt",false,"PAGE_SWAP_TRACE.pst"));
+	unlink("PAGE_SWAP_TRACE.txt");
+	unlink("PAGE_SWAP_TRACE.bin");
+}
+
+TEST (TRACEFILE, RejectsCorruptFiles) {
+	const uint16_t pages[] = {10,20,30};
+	ASSERT_EQ(true,page_swap_trace_write("PAGE_SWAP_TRACE.pst",pages,3));
+	FILE* file = fopen("PAGE_SWAP_TRACE.pst","rb");
+	ASSERT_NE((FILE*)NULL,file);
+	unsigned char bytes[64];
+	const size_t size = fread(bytes,1,sizeof(bytes),file);
+	fclose(file);
+	// header, three one byte varints and two index entries
+	ASSERT_EQ(32 + 3 + 16,size);
+
+	// truncated, wrong magic, wrong reference count
+	ASSERT_EQ(true,write_file("PAGE_SWAP_TRACE.pst",bytes,size - 1));
+	ASSERT_EQ((page_swap_trace_t*)NULL,page_swap_trace_open("PAGE_SWAP_TRACE.pst"));
+	bytes[0] = 'X';
+	ASSERT_EQ(true,write_file("PAGE_SWAP_TRACE.pst",bytes,size));
+	ASSERT_EQ((page_swap_trace_t*)NULL,page_swap_trace_open("PAGE_SWAP_TRACE.pst"));
+	bytes[0] = 'P';
+	bytes[8] = 0;
+	ASSERT_EQ(true,write_file("PAGE_SWAP_TRACE.pst",bytes,size));
+	ASSERT_EQ((page_swap_trace_t*)NULL,page_swap_trace_open("PAGE_SWAP_TRACE.pst"));
+	bytes[8] = 3;
+
+	// a varint running past the end of its chunk opens but does not decode
+	bytes[34] = 0x80;
+	ASSERT_EQ(true,write_file("PAGE_SWAP_TRACE.pst",bytes,size));
+	page_swap_trace_t* trace = page_swap_trace_open("PAGE_SWAP_TRACE.pst");
+	ASSERT_NE((page_swap_trace_t*)NULL,trace);
+	uint16_t decoded[PAGE_SWAP_TRACE_CHUNK_REFERENCES];
+	ASSERT_EQ(SIZE_MAX,page_swap_trace_chunk(trace,0,decoded));
+	page_swap_trace_close(trace);
+	unlink("PAGE_SWAP_TRACE.pst");
+}
+
+TEST (TRACEFILE, ReplayMatchesDirectRequests) {
+	std::vector<uint16_t> pages(20000);
+	unsigned int seed = 11;
+	for (size_t i = 0; i < pages.size(); ++i) {
+		pages[i] = rand_r(&seed) % 4 ? rand_r(&seed) % 40 : rand_r(&seed) % 256;
+	}
+	ASSERT_EQ(true,page_swap_trace_write("PAGE_SWAP_TRACE.pst",pages.data(),pages.size()));
+	page_swap_trace_t* trace = page_swap_trace_open("PAGE_SWAP_TRACE.pst");
+	ASSERT_NE((page_swap_trace_t*)NULL,trace);
+
+	page_swap_t* replayed = page_swap_create("PAGE_SWAP_REPLAY",256,32);
+	page_swap_t* direct = page_swap_create("PAGE_SWAP_DIRECT",256,32);
+	ASSERT_NE((page_swap_t*)NULL,replayed);
+	ASSERT_NE((page_swap_t*)NULL,direct);
+	ASSERT_EQ(SIZE_MAX,page_swap_trace_replay(trace,replayed,PAGE_SWAP_WSCLOCK,1));
+	ASSERT_EQ(SIZE_MAX,page_swap_trace_replay(NULL,replayed,PAGE_SWAP_WSCLOCK,0));
+	const size_t faults = page_swap_trace_replay(trace,replayed,PAGE_SWAP_WSCLOCK,0);
+	size_t direct_faults = 0;
+	for (size_t i = 0; i < pages.size(); ++i) {
+		page_request_result_t* result = page_swap_request(direct,PAGE_SWAP_WSCLOCK,pages[i],i,false);
+		direct_faults += result != NULL;
+		free(result);
+	}
+	ASSERT_EQ(direct_faults,faults);
+	for (size_t frame = 0; frame < 32; ++frame) {
+		ASSERT_EQ(direct->frame_table.page_table_idx[frame],replayed->frame_table.page_table_idx[frame]);
+	}
+	page_swap_destroy(direct);
+
+	// pages outside the page table stop the replay
+	page_swap_t* small = page_swap_create("PAGE_SWAP_REPLAY_SMALL",64,32);
+	ASSERT_NE((page_swap_t*)NULL,small);
+	ASSERT_EQ(SIZE_MAX,page_swap_trace_replay(trace,small,PAGE_SWAP_WSCLOCK,0));
+	page_swap_destroy(small);
+	page_swap_destroy(replayed);
+	page_swap_trace_close(trace);
+	unlink("PAGE_SWAP_TRACE.pst");
+}
+
+TEST (SWEEP, MatchesSerialReplays) {
+	const char* const paths[] = {"PAGE_SWAP_SWEEP_A.pst","PAGE_SWAP_SWEEP_B.pst"};
+	std::vector<uint16_t> pages(30000);
+	unsigned int seed = 17;
+	for (size_t t = 0; t < 2; ++t) {
+		for (size_t i = 0; i < pages.size(); ++i) {
+			pages[i] = t ? i % 300 : (rand_r(&seed) % 3 ? rand_r(&seed) % 50 : rand_r(&seed) % 500);
+		}
+		ASSERT_EQ(true,page_swap_trace_write(paths[t],pages.data(),pages.size()));
+	}
+	const page_swap_policy_t policies[] = {PAGE_SWAP_ALRU,PAGE_SWAP_WSCLOCK,PAGE_SWAP_MGLRU};
+	const size_t frame_counts[] = {32,256};
+	page_swap_sweep_result_t results[12];
+
+	ASSERT_EQ(false,page_swap_sweep(paths,0,policies,3,frame_counts,2,"PAGE_SWAP_SWEEP",4,results));
+	const page_swap_policy_t bad_policy[] = {(page_swap_policy_t) (PAGE_SWAP_OPT + 1)};
+	ASSERT_EQ(false,page_swap_sweep(paths,2,bad_policy,1,frame_counts,2,"PAGE_SWAP_SWEEP",4,results));
+	const char* const missing[] = {"PAGE_SWAP_NO_SUCH_TRACE.pst"};
+	ASSERT_EQ(false,page_swap_sweep(missing,1,policies,3,frame_counts,2,"PAGE_SWAP_SWEEP",4,results));
+
+	ASSERT_EQ(true,page_swap_sweep(paths,2,policies,3,frame_counts,2,"PAGE_SWAP_SWEEP",4,results));
+	for (size_t cell = 0; cell < 12; ++cell) {
+		const page_swap_sweep_result_t* result = &results[cell];
+		ASSERT_EQ(paths[cell / 6],result->trace);
+		ASSERT_EQ(policies[cell / 2 % 3],result->policy);
+		ASSERT_EQ(frame_counts[cell % 2],result->frame_count);
+		ASSERT_EQ(30000,result->references);
+
+		// the same cell run on its own
+		page_swap_trace_t* trace = page_swap_trace_open(result->trace);
+		ASSERT_NE((page_swap_trace_t*)NULL,trace);
+		page_swap_t* context = page_swap_create_lazy("PAGE_SWAP_SWEEP_SERIAL",1,cell < 6 ? 500 : 300,result->frame_count);
+		ASSERT_NE((page_swap_t*)NULL,context);
+		ASSERT_EQ(page_swap_trace_replay(trace,context,result->policy,0),result->faults);
+		ASSERT_DOUBLE_EQ((double) result->faults / 30000,result->fault_rate);
+		page_swap_destroy(context);
+		page_swap_trace_close(trace);
+	}
+	unlink(paths[0]);
+	unlink(paths[1]);
+}
+
+TEST (SWEEP, RunsOptAndListPolicies) {
+	const char* const paths[] = {"PAGE_SWAP_SWEEP_OPT.pst"};
+	std::vector<uint16_t> pages(100000);
+	unsigned int seed = 23;
+	for (size_t i = 0; i < pages.size(); ++i) {
+		pages[i] = rand_r(&seed) % 4 ? rand_r(&seed) % 40 : rand_r(&seed) % 400;
+	}
+	ASSERT_EQ(true,page_swap_trace_write(paths[0],pages.data(),pages.size()));
+	const page_swap_policy_t policies[] = {PAGE_SWAP_OPT,PAGE_SWAP_ARC,PAGE_SWAP_2Q,PAGE_SWAP_LIRS};
+	const size_t frame_counts[] = {1,32};
+	page_swap_sweep_result_t results[8];
+	ASSERT_EQ(true,page_swap_sweep(paths,1,policies,4,frame_counts,2,"PAGE_SWAP_SWEEP",4,results));
+
+	// OPT spans more than one chunk of the trace and bounds every other cell
+	ASSERT_EQ(optimal_page_faults(pages.data(),pages.size(),1),results[0].faults);
+	ASSERT_EQ(optimal_page_faults(pages.data(),pages.size(),32),results[1].faults);
+	for (size_t cell = 2; cell < 8; ++cell) {
+		ASSERT_EQ(policies[cell / 2],results[cell].policy);
+		if (results[cell].policy == PAGE_SWAP_LIRS && results[cell].frame_count == 1) {
+			// LIRS cannot run in one frame
+			ASSERT_EQ(SIZE_MAX,results[cell].faults);
+			continue;
+		}
+		ASSERT_LE(results[cell % 2].faults,results[cell].faults);
+	}
+
+	// a context cannot replay OPT
+	page_swap_trace_t* trace = page_swap_trace_open(paths[0]);
+	ASSERT_NE((page_swap_trace_t*)NULL,trace);
+	page_swap_t* context = page_swap_create_lazy("PAGE_SWAP_SWEEP_SERIAL",1,400,32);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(SIZE_MAX,page_swap_trace_replay(trace,context,PAGE_SWAP_OPT,0));
+	ASSERT_EQ(results[3].faults,page_swap_trace_replay(trace,context,PAGE_SWAP_ARC,0));
+	page_swap_destroy(context);
+	page_swap_trace_close(trace);
+	unlink(paths[0]);
+}
+
+TEST (SWEEP, WritesCsvAndJson) {
+	page_swap_sweep_result_t results[2];
+	results[0].trace = "a.pst";
+	results[0].policy = PAGE_SWAP_CLOCK;
+	results[0].frame_count = 64;
+	results[0].references = 1000;
+	results[0].faults = 250;
+	results[0].fault_rate = 0.25;
+	results[0].seconds = 0.5;
+	results[1] = results[0];
+	results[1].trace = "b\"c.pst";
+	results[1].policy = PAGE_SWAP_MGLRU;
+	results[1].faults = SIZE_MAX;
+	results[1].fault_rate = 0;
+	ASSERT_EQ(false,page_swap_sweep_write(NULL,results,2,false));
+	ASSERT_STREQ("LFU_EXACT",page_swap_policy_name(PAGE_SWAP_LFU_EXACT));
+	ASSERT_EQ(NULL,page_swap_policy_name((page_swap_policy_t) (PAGE_SWAP_OPT + 1)));
+
+	char buffer[1024];
+	FILE* out = fmemopen(buffer,sizeof(buffer),"w");
+	ASSERT_NE((FILE*)NULL,out);
+	ASSERT_EQ(true,page_swap_sweep_write(out,results,2,false));
+	fclose(out);
+	ASSERT_STREQ("trace,policy,frames,references,faults,fault_rate,seconds\n"
+		"a.pst,CLOCK,64,1000,250,0.250000,0.500000\n"
+		"b\"c.pst,MGLRU,64,1000,-1,0.000000,0.500000\n",buffer);
+
+	out = fmemopen(buffer,sizeof(buffer),"w");
+	ASSERT_NE((FILE*)NULL,out);
+	ASSERT_EQ(true,page_swap_sweep_write(out,results,2,true));
+	fclose(out);
+	ASSERT_STREQ("[\n{\"trace\":\"a.pst\",\"policy\":\"CLOCK\",\"frames\":64,\"references\":1000,\"faults\":250,"
+		"\"fault_rate\":0.250000,\"seconds\":0.500000},\n{\"trace\":\"b\\\"c.pst\",\"policy\":\"MGLRU\",\"frames\":64,"
+		"\"references\":1000,\"faults\":-1,\"fault_rate\":0.000000,\"seconds\":0.500000}\n]\n",buffer);
+}
+
+TEST (COW, ForkSharesFramesUntilWritten) {
+	page_swap_t* context = page_swap_create_processes("PAGE_SWAP_COW",3,64,16);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	page_swap_cow_stats_t stats;
+	ASSERT_EQ(false,page_swap_fork(NULL,0,1));
+	ASSERT_EQ(false,page_swap_fork(context,0,0));
+	ASSERT_EQ(false,page_swap_fork(context,0,3));
+	ASSERT_EQ(false,page_swap_fork(context,1,0));
+	ASSERT_EQ(false,page_swap_cow_stats(context,NULL));
+
+	ASSERT_EQ(true,page_swap_fork(context,0,1));
+	ASSERT_EQ(false,page_swap_fork(context,0,1));
+	ASSERT_EQ(true,page_swap_cow_stats(context,&stats));
+	ASSERT_EQ(1,stats.forks);
+	ASSERT_EQ(16,stats.shared_frames);
+	ASSERT_EQ(16,stats.shared_mappings);
+	ASSERT_EQ(16 * 1024,stats.memory_saved_bytes);
+	// shared frames cannot become huge pages or views of one back store page
+	ASSERT_EQ(false,page_swap_set_huge_pages(context,4,2));
+	ASSERT_EQ(false,page_swap_set_zero_copy(context,true));
+
+	// reading a shared page is a hit, the first write copies it
+	ASSERT_EQ(true,page_swap_set_concurrent(context,true));
+	ASSERT_EQ(NULL,page_swap_process_request(context,PAGE_SWAP_CLOCK,1,3,0,false));
+	ASSERT_EQ(NULL,page_swap_process_request(context,PAGE_SWAP_CLOCK,1,3,1,true));
+	const page_t* parent = &context->page_tables[0].entries[3];
+	const page_t* child = &context->page_tables[1].entries[3];
+	ASSERT_EQ(1,parent->valid);
+	ASSERT_EQ(1,child->valid);
+	ASSERT_NE(parent->frame_table_idx,child->frame_table_idx);
+	ASSERT_EQ(0,child->cow);
+	ASSERT_EQ(0,memcmp(frame_bytes(context,parent->frame_table_idx),frame_bytes(context,child->frame_table_idx),1024));
+	ASSERT_EQ(true,page_swap_cow_stats(context,&stats));
+	ASSERT_EQ(1,stats.pages_copied);
+	ASSERT_EQ(0,stats.copies_avoided);
+
+	// the copy took a frame the clock picked, so one more page lost its sharing
+	ASSERT_EQ(14,stats.shared_frames);
+	page_swap_process_stats_t process;
+	ASSERT_EQ(true,page_swap_process_stats(context,1,&process));
+	ASSERT_EQ(1,process.frames_held);
+	ASSERT_EQ(0,process.faults);
+
+	// the parent is the last process mapping its frame now, it writes in place
+	ASSERT_EQ(NULL,page_swap_process_request(context,PAGE_SWAP_CLOCK,0,3,2,true));
+	ASSERT_EQ(true,page_swap_cow_stats(context,&stats));
+	ASSERT_EQ(1,stats.pages_copied);
+	ASSERT_EQ(1,stats.copies_avoided);
+	ASSERT_EQ(0,parent->cow);
+
+	// a second child shares the parent frames again
+	ASSERT_EQ(true,page_swap_fork(context,0,2));
+	ASSERT_EQ(true,page_swap_cow_stats(context,&stats));
+	ASSERT_EQ(2,stats.forks);
+	ASSERT_EQ(14 + 15,stats.shared_mappings);
+	page_swap_destroy(context);
+}
+
+TEST (COW, ChildInheritsParentData) {
+	page_swap_t* context = page_swap_create_processes("PAGE_SWAP_COW",2,64,16);
+	ASSERT_NE((page_swap_t*)NULL,context);
+
+	// page 5 is resident, page 40 only in the back store
+	unsigned char data[1024];
+	memset(frame_bytes(context,context->page_tables[0].entries[5].frame_table_idx),0xab,1024);
+	memset(data,0xcd,1024);
+	ASSERT_EQ(true,write_page(context,0,data,40));
+	ASSERT_EQ(true,page_swap_fork(context,0,1));
+
+	free(page_swap_process_request(context,PAGE_SWAP_CLOCK,1,40,0,false));
+	ASSERT_EQ(0,memcmp(data,frame_bytes(context,context->page_tables[1].entries[40].frame_table_idx),1024));
+
+	// faults of the child replace every shared frame, each process keeps the data
+	for (uint16_t page_number = 16; page_number < 64; ++page_number) {
+		free(page_swap_process_request(context,PAGE_SWAP_CLOCK,1,page_number,page_number,false));
+	}
+	page_swap_cow_stats_t stats;
+	ASSERT_EQ(true,page_swap_cow_stats(context,&stats));
+	ASSERT_EQ(0,stats.shared_frames);
+	ASSERT_EQ(0,context->page_tables[0].entries[5].valid);
+	ASSERT_EQ(0,context->page_tables[1].entries[5].valid);
+
+	memset(data,0xab,1024);
+	free(page_swap_process_request(context,PAGE_SWAP_CLOCK,1,5,100,false));
+	ASSERT_EQ(0,memcmp(data,frame_bytes(context,context->page_tables[1].entries[5].frame_table_idx),1024));
+	free(page_swap_process_request(context,PAGE_SWAP_CLOCK,0,5,101,false));
+	ASSERT_EQ(0,memcmp(data,frame_bytes(context,context->page_tables[0].entries[5].frame_table_idx),1024));
+	page_swap_destroy(context);
+}
+
+TEST (COW, LazyChildInheritsPooledData) {
+	page_swap_t* context = page_swap_create_lazy("PAGE_SWAP_COW",2,64,16);
+	ASSERT_NE((page_swap_t*)NULL,context);
+	ASSERT_EQ(true,page_swap_set_compressed_pool(context,64 * 1024));
+
+	// page 40 of the parent is written and pushed out to the pool, never to the back store
+	free(page_swap_process_request(context,PAGE_SWAP_CLOCK,0,40,0,true));
+	memset(frame_bytes(context,context->page_tables[0].entries[40].frame_table_idx),0x5a,1024);
+	for (uint16_t page_number = 16; page_number < 40; ++page_number) {
+		free(page_swap_process_request(context,PAGE_SWAP_CLOCK,0,page_number,page_number,false));
+	}
+	ASSERT_EQ(0,context->page_tables[0].entries[40].valid);
+	ASSERT_NE(NO_SLOT,context->pool->slot_of[40]);
+	ASSERT_EQ(true,page_swap_fork(context,0,1));
+
+	unsigned char data[1024];
+	memset(data,0x5a,1024);
+	free(page_swap_process_request(context,PAGE_SWAP_CLOCK,1,40,100,false));
+	ASSERT_EQ(0,memcmp(data,frame_bytes(context,context->page_tables[1].entries[40].frame_table_idx),1024));
+	page_swap_destroy(context);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
 		::testing::AddGlobalTestEnvironment(new GradeEnvironment);